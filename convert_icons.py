@@ -1,23 +1,85 @@
+from fnmatch import fnmatch
 from pathlib import Path
 from PIL import Image
 from svglib.svglib import svg2rlg
 from reportlab.graphics import renderPM
 import io
 
-def svg_to_bitmap_header(svg_dir, svg_path, output_path):
-    # Convert SVG to PNG using pure Python implementation
-    drawing = svg2rlg(str(svg_path))
+# Sizes the library draws icons at: toggle segments and menu widgets (20), list rows (24), buttons (32)
+DEFAULT_SIZES = [20, 24, 32, 48]
+
+
+# 4x4 Bayer matrix for ordered dithering between gray levels
+BAYER_4X4 = [
+    [0, 8, 2, 10],
+    [12, 4, 14, 6],
+    [3, 11, 1, 9],
+    [15, 7, 13, 5],
+]
+DITHER_MODES = ["none", "bayer", "floyd-steinberg"]
+
+
+def render_svg(drawing, size):
+    """Render the drawing so its longer side is size pixels, keeping the aspect ratio, as 8-bit grayscale."""
+    scale = size / max(drawing.width, drawing.height)
+    width = max(1, round(drawing.width * scale))
+    height = max(1, round(drawing.height * scale))
+    drawing.scale(width / drawing.width, height / drawing.height)
+    drawing.width = width
+    drawing.height = height
 
     # Use memory buffer instead of temporary file
     png_data = io.BytesIO()
     renderPM.drawToFile(drawing, png_data, fmt="PNG", dpi=72)
     png_data.seek(0)
 
-    # Open PNG and convert to 1-bit bitmap
-    img = Image.open(png_data).convert('1')
+    return Image.open(png_data).convert('L').crop((0, 0, width, height))
+
+
+def to_mono(img):
+    # Threshold instead of dithering, dithered edges look ragged at icon sizes
+    return img.point(lambda p: 255 if p >= 128 else 0, mode='1')
+
+
+def quantize_gray(img, dither="none"):
+    """Rows of levels 0 (white) to 3 (black), for Controller::drawGrayBitmap()."""
     width, height = img.size
+    # Darkness in level units, 0.0 to 3.0
+    values = [[(255 - img.getpixel((x, y))) * 3 / 255 for x in range(width)] for y in range(height)]
+    levels = [[0] * width for _ in range(height)]
+    for y in range(height):
+        for x in range(width):
+            value = values[y][x]
+            if dither == "bayer":
+                level = int(value + (BAYER_4X4[y % 4][x % 4] + 0.5) / 16)
+            else:
+                level = int(value + 0.5)
+            level = max(0, min(3, level))
+            levels[y][x] = level
 
-    # Convert to bitmap array
+            if dither == "floyd-steinberg":
+                error = value - level
+                for dx, dy, weight in ((1, 0, 7), (-1, 1, 3), (0, 1, 5), (1, 1, 1)):
+                    if 0 <= x + dx < width and y + dy < height:
+                        values[y + dy][x + dx] += error * weight / 16
+    return levels
+
+
+def pack_gray(levels):
+    """2bpp rows padded to whole bytes, 4 pixels per byte, MSB first."""
+    bitmap_data = []
+    for row in levels:
+        for i in range(0, len(row), 4):
+            byte = 0
+            for j in range(4):
+                byte = (byte << 2) | (row[i + j] if i + j < len(row) else 0)
+            bitmap_data.append(byte)
+    return bitmap_data
+
+
+def pack_bitmap(img):
+    """1bpp rows padded to whole bytes, MSB first, set bits are black pixels."""
+    width, height = img.size
     bitmap_data = []
     for y in range(height):
         byte = 0
@@ -33,33 +95,113 @@ def svg_to_bitmap_header(svg_dir, svg_path, output_path):
         if bit_count > 0:
             byte = byte << (8 - bit_count)
             bitmap_data.append(byte)
+    return bitmap_data
+
+
+def format_bytes(bitmap_data):
+    return ",\n        ".join([", ".join(f"0x{b:02X}" for b in bitmap_data[i:i+12])
+                               for i in range(0, len(bitmap_data), 12)])
+
+
+def packbits(data):
+    """PackBits over the whole bitmap, as EPD::PackBitsReader decodes it.
+
+    Runs of 3 or more equal bytes become a repeat, everything else literals."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 3:
+            out.append(257 - run)
+            out.append(data[i])
+            i += run
+            continue
+
+        start = i
+        while i < len(data) and i - start < 128 and not (
+                i + 2 < len(data) and data[i] == data[i + 1] == data[i + 2]):
+            i += 1
+        out.append(i - start - 1)
+        out.extend(data[start:i])
+    return bytes(out)
+
+
+def render_icon(svg_path, sizes, compress=False, gray=False, dither="none"):
+    """(size, width, height, stored bytes, encoding, raw byte count) per size.
+
+    Every size is rendered from the SVG itself, which looks better than
+    scaling one bitmap at runtime. With compress a bitmap is stored PackBits
+    encoded where that is smaller; with gray it is stored as 2bpp levels."""
+    bitmaps = []
+    for size in sorted(set(sizes)):
+        img = render_svg(svg2rlg(str(svg_path)), size)
+        width, height = img.size
+        if gray:
+            data = bytes(pack_gray(quantize_gray(img, dither)))
+            bitmaps.append((size, width, height, data, "GRAY2", len(data)))
+            continue
+
+        raw = bytes(pack_bitmap(to_mono(img)))
+        packed = packbits(raw) if compress else raw
+        if len(packed) < len(raw):
+            bitmaps.append((size, width, height, packed, "PACKBITS", len(raw)))
+        else:
+            bitmaps.append((size, width, height, raw, "RAW", len(raw)))
+    return bitmaps
+
+
+def describe_size(bitmaps):
+    raw = sum(bitmap[5] for bitmap in bitmaps)
+    stored = sum(len(bitmap[3]) for bitmap in bitmaps)
+    return f"{raw} bytes" if raw == stored else f"{stored} of {raw} bytes"
+
+
+def is_gray(svg_dir, svg_path, gray_patterns):
+    """Whether the icon is listed with --gray, matching its path below svg_dir."""
+    relative_path = svg_path.relative_to(svg_dir).as_posix()
+    return any(fnmatch(relative_path, pattern) for pattern in gray_patterns or [])
+
+
+def icon_name(svg_dir, svg_path):
+    path_parts = svg_path.relative_to(svg_dir).with_suffix('').parts
+    return '_'.join(part.replace('-', '_') for part in path_parts)
+
+
+def svg_to_bitmap_header(svg_dir, svg_path, output_path, sizes, compress=False, gray=False, dither="none"):
+    bitmaps = render_icon(svg_path, sizes, compress, gray, dither)
 
     # Create directory if it doesn't exist
     output_path.parent.mkdir(parents=True, exist_ok=True)
 
-    path_parts = svg_path.relative_to(svg_dir).with_suffix('').parts
-    sanitized_name = '_'.join(part.replace('-', '_') for part in path_parts)
+    sanitized_name = icon_name(svg_dir, svg_path)
 
     # Write header file
     with open(output_path, 'w') as f:
         f.write(f"""#pragma once
 #include <EPDIcon.h>
-// Auto-generated from {svg_path.name}
+// Auto-generated from {svg_path.name}, sizes {", ".join(str(size) for size in sorted(set(sizes)))}
 inline EPD::Icon &{sanitized_name}_icon() {{
-    static const unsigned char PROGMEM bitmap[] = {{
-        """)
-        f.write(",\n        ".join([", ".join(f"0x{b:02X}" for b in bitmap_data[i:i+12])
-                                for i in range(0, len(bitmap_data), 12)]))
-        f.write(f"""
+""")
+        for size, _, _, bitmap_data, _, _ in bitmaps:
+            f.write(f"""    static const unsigned char PROGMEM bitmap{size}[] = {{
+        {format_bytes(bitmap_data)}
     }};
-    static const auto icon = new EPD::Icon({{{width}, {height}}}, bitmap);
+""")
+        f.write("    static const EPD::IconBitmap sizes[] = {\n")
+        for size, width, height, _, encoding, _ in bitmaps:
+            f.write(f"        {{{width}, {height}, bitmap{size}, EPD::IconEncoding::{encoding}}},\n")
+        f.write(f"""    }};
+    static const auto icon = new EPD::Icon(sizes);
     return *icon;
 }}
 
 //#define {sanitized_name}_icon {sanitized_name}_icon()
 """)
 
-    print(f"Converted: {svg_path} -> {output_path}")
+    print(f"Converted: {svg_path} -> {output_path} ({describe_size(bitmaps)})")
+    return bitmaps
 
 
 def generate_index_header(output_dir: Path, icon_files: list):
@@ -75,10 +217,86 @@ def generate_index_header(output_dir: Path, icon_files: list):
         
         print(f"Generated index header: {index_path}")
 
-def process_svg_directory(svg_dir: Path | str | None = None, output_dir: Path | str | None = None):
+def generate_atlas(output_dir: Path, source_path: Path, icons: list):
+    """Pack all icons into one blob with an index, see --atlas.
+
+    icons holds (name, bitmaps) as returned by render_icon(). Every bitmap is
+    stored once; icons that render to identical bitmaps share the bytes."""
+    blob = bytearray()
+    offsets = {}
+    index = []   # (width, height, offset) per bitmap, grouped by icon
+    handles = []  # (name, first index entry, entry count)
+    for name, bitmaps in icons:
+        handles.append((name, len(index), len(bitmaps)))
+        for _, width, height, bitmap_data, encoding, _ in bitmaps:
+            key = (width, height, encoding, bitmap_data)
+            if key not in offsets:
+                offsets[key] = len(blob)
+                blob.extend(bitmap_data)
+            index.append((width, height, offsets[key], encoding))
+    shared = len(index) - len(offsets)
+
+    index_path = output_dir / "icons.h"
+    with open(index_path, 'w') as f:
+        f.write(f"""#pragma once
+#include <EPDIcon.h>
+
+// Auto-generated icon atlas: {len(handles)} icons, {len(blob)} bytes, {shared} bitmaps shared.
+// The data lives in {source_path.name}, which has to be compiled into the firmware.
+
+namespace icons {{
+    extern const unsigned char ATLAS[];
+    extern const EPD::IconBitmap ATLAS_INDEX[{len(index)}];
+
+""")
+        for name, first, count in handles:
+            f.write(f"    constexpr EPD::IconHandle {name}{{{first}, {count}}};\n")
+        f.write("""
+    /** Sizes of the icon behind handle. */
+    inline EPD::Span<const EPD::IconBitmap> sizesOf(const EPD::IconHandle handle) {
+        return {ATLAS_INDEX + handle.first, handle.count};
+    }
+}
+
+""")
+        for name, _, _ in handles:
+            f.write(f"EPD::Icon &{name}_icon();\n")
+    print(f"Generated atlas header: {index_path}")
+
+    source_path.parent.mkdir(parents=True, exist_ok=True)
+    with open(source_path, 'w') as f:
+        f.write(f"""// Auto-generated icon atlas, see icons.h
+#include <EPDController.h>
+#include <EPDIcon.h>
+
+namespace icons {{
+    extern const unsigned char PROGMEM ATLAS[] = {{
+        {format_bytes(blob)}
+    }};
+
+    extern const EPD::IconBitmap ATLAS_INDEX[{len(index)}] = {{
+""")
+        for width, height, offset, encoding in index:
+            f.write(f"        {{{width}, {height}, ATLAS + {offset}, EPD::IconEncoding::{encoding}}},\n")
+        f.write("    };\n}\n")
+        for name, first, count in handles:
+            f.write(f"""
+EPD::Icon &{name}_icon() {{
+    static EPD::Icon icon(EPD::Span<const EPD::IconBitmap>(icons::ATLAS_INDEX + {first}, {count}));
+    return icon;
+}}
+""")
+    print(f"Generated atlas data: {source_path}")
+
+
+def process_svg_directory(svg_dir: Path | str | None = None, output_dir: Path | str | None = None,
+                          sizes: list[int] | None = None, atlas_source: Path | str | None = None,
+                          compress: bool = False, gray_patterns: list[str] | None = None,
+                          dither: str = "none"):
     # Fallbacks to original defaults if not provided
     svg_dir = Path(svg_dir) if svg_dir is not None else Path("icons")
     output_dir = Path(output_dir) if output_dir is not None else Path("include/icons")
+    sizes = sizes if sizes else DEFAULT_SIZES
 
     if not svg_dir.exists():
         print(f"Error: Source directory {svg_dir} does not exist!")
@@ -87,7 +305,23 @@ def process_svg_directory(svg_dir: Path | str | None = None, output_dir: Path |
     # Create output directory if it doesn't exist
     output_dir.mkdir(parents=True, exist_ok=True)
 
+    if atlas_source is not None:
+        atlas_icons = []
+        for svg_path in sorted(svg_dir.rglob("*.svg")):
+            try:
+                bitmaps = render_icon(svg_path, sizes, compress, is_gray(svg_dir, svg_path, gray_patterns), dither)
+                atlas_icons.append((icon_name(svg_dir, svg_path), bitmaps))
+                print(f"Converted: {svg_path} ({describe_size(bitmaps)})")
+            except Exception as e:
+                print(f"Error processing {svg_path}: {e}")
+        if atlas_icons:
+            generate_atlas(output_dir, Path(atlas_source), atlas_icons)
+        all_bitmaps = [bitmap for _, bitmaps in atlas_icons for bitmap in bitmaps]
+        print(f"\nProcessed {len(atlas_icons)} icons, bitmaps {describe_size(all_bitmaps)}")
+        return
+
     generated_files = []
+    all_bitmaps = []
 
     # Process all SVG files recursively
     for svg_path in svg_dir.rglob("*.svg"):
@@ -96,7 +330,8 @@ def process_svg_directory(svg_dir: Path | str | None = None, output_dir: Path |
         output_path = output_dir / relative_path.with_suffix('.h')
 
         try:
-            svg_to_bitmap_header(svg_dir, svg_path, output_path)
+            all_bitmaps.extend(svg_to_bitmap_header(svg_dir, svg_path, output_path, sizes, compress,
+                                                    is_gray(svg_dir, svg_path, gray_patterns), dither))
             generated_files.append(output_path)
         except Exception as e:
             print(f"Error processing {svg_path}: {e}")
@@ -105,7 +340,7 @@ def process_svg_directory(svg_dir: Path | str | None = None, output_dir: Path |
     if generated_files:
         generate_index_header(output_dir, generated_files)
 
-    print(f"\nProcessed {len(generated_files)} icons")
+    print(f"\nProcessed {len(generated_files)} icons, bitmaps {describe_size(all_bitmaps)}")
 
 
 if __name__ == "__main__":
@@ -126,11 +361,54 @@ if __name__ == "__main__":
         default=None,
         help="Directory where generated headers will be written (default: ./include/icons)",
     )
+    parser.add_argument(
+        "--sizes",
+        dest="sizes",
+        type=lambda value: [int(size) for size in value.split(",") if size.strip()],
+        default=None,
+        help="Comma-separated pixel sizes to render every icon at, e.g. 18,24,32 "
+             f"(default: {','.join(str(size) for size in DEFAULT_SIZES)})",
+    )
+
+    parser.add_argument(
+        "--atlas",
+        dest="atlas_source",
+        nargs="?",
+        const="src/icon_atlas.cpp",
+        default=None,
+        help="Pack all icons into one deduplicated blob in this source file (default: ./src/icon_atlas.cpp) "
+             "and write only a small icons.h with handles, instead of one header per icon",
+    )
+
+    parser.add_argument(
+        "--compress",
+        dest="compress",
+        action="store_true",
+        help="Store bitmaps PackBits compressed where that saves flash; they are then always drawn at their own size",
+    )
+
+    parser.add_argument(
+        "--gray",
+        dest="gray_patterns",
+        action="append",
+        default=None,
+        metavar="PATTERN",
+        help="Store icons whose path below --svg-dir matches PATTERN (e.g. 'illustrations/*') with 4 gray levels "
+             "at 2 bits per pixel; may be given several times. Gray shows after a full refresh only",
+    )
+    parser.add_argument(
+        "--dither",
+        dest="dither",
+        choices=DITHER_MODES,
+        default="none",
+        help="Dithering between the gray levels of --gray icons (default: none)",
+    )
 
     args = parser.parse_args()
 
     print("=" * 50)
     print("convert_icons.py is being executed!")
-    process_svg_directory(args.svg_dir, args.output_dir)
+    process_svg_directory(args.svg_dir, args.output_dir, args.sizes, args.atlas_source, args.compress,
+                          args.gray_patterns, args.dither)
     print("convert_icons.py is DONE!")
     print("=" * 50)
\ No newline at end of file
@@ -5,13 +5,14 @@
  * @file SamplePage.h
  * Example page demonstrating common GXUI interactables and components.
  *
- * Shows buttons, sliders, toggles, dropdowns, text input, and a progress bar
- * with simple event handlers. Use this as a reference for building your own
+ * Shows buttons, sliders, toggles, dropdowns, text input, a virtualized list
+ * and a progress bar with simple event handlers. Use this as a reference for building your own
  * pages. Requires icon mapping from epd/IconMapper.h.
  */
 
 #include "EPDPage.h"
 #include "EPDComponent.h"
+#include "EPDLayout.h"
 #include <vector>
 #include <epd/IconMapper.h>
 
@@ -48,6 +49,9 @@ private:
 
     float prog = 0.47f;
 
+    // Widget positions are computed once by the layout and cached between frames
+    VStack layout{16};
+
 public:
     SamplePage(): Page() {
         addInteractable(
@@ -116,9 +120,39 @@ public:
                 &textInput
             )
         );
+
+        layout.add(getInteractable("btn1"))
+                .add(getInteractable("btn2"))
+                .add(getInteractable("sli1"))
+                .add(getInteractable("sli2"))
+                .add(getInteractable("tgl1"));
+
+        layout.emplace<HStack>(24)
+                .add(getInteractable("drp1"))
+                .add(getInteractable("txt1"));
+
+        // Rows are generated on demand, only the visible ones are kept in memory
+        addInteractable(
+            std::make_unique<InteractableList>(
+                "lst1",
+                1000,
+                [](const size_t index, ListRow &row) {
+                    char number[12];
+                    snprintf(number, sizeof(number), "%u", static_cast<unsigned>(index));
+                    row.text.append("Log entry ").append(number);
+                },
+                3,
+                [](const size_t index) {
+                    Serial.printf("List row %u selected\n", static_cast<unsigned>(index));
+                }
+            )
+        );
+
+        layout.emplace<ComponentProgressBar>("Progress 1", prog);
+        layout.add(getInteractable("lst1"));
     }
 
-    [[nodiscard]] String getTitle() const {
+    [[nodiscard]] StringRef getTitle() const {
         return "Sample Dashboard";
     }
 
@@ -136,22 +170,7 @@ public:
         display.setCursor(display.width() - 120, 40);
         display.print("12:34 PM");
 
-
-        getInteractable("btn1")->executeRender(epd, RenderContext{20, 100});
-        getInteractable("btn2")->executeRender(epd, RenderContext{20, 150});
-
-        getInteractable("sli1")->executeRender(epd, RenderContext{20, 200});
-        getInteractable("sli2")->executeRender(epd, RenderContext{20, 250});
-
-        getInteractable("tgl1")->executeRender(epd, RenderContext{20, 300});
-        //getInteractable("tgl1")->executeRender(epd, RenderContext{20, 420});
-
-
-        getInteractable("drp1")->executeRender(epd, RenderContext{20, 350});
-        getInteractable("txt1")->executeRender(epd, RenderContext{200, 350});
-
-        std::make_unique<ComponentProgressBar>("Progress 1", prog)
-                ->renderContent(epd, RenderContext{20, 400});
+        layout.executeRender(epd, RenderContext{16, 64});
 
         // Pattern demonstrations
         display.setFont(&FreeMonoBold12pt7b);
@@ -194,12 +213,12 @@ private:
 
             // Box title
             display.setCursor(x + 10, startY + 25);
-            display.print("Stat " + String(i + 1));
+            display.printf("Stat %d", i + 1);
 
             // Box value
             display.setFont(&FreeMono12pt7b);
             display.setCursor(x + 10, startY + 60);
-            display.print(String(random(100)) + "%");
+            display.printf("%ld%%", random(100));
         }
     }
 
@@ -268,7 +287,7 @@ class PatternDemoPage : public Page {
 public:
     PatternDemoPage() : Page() {}
 
-    [[nodiscard]] String getTitle() const override {
+    [[nodiscard]] StringRef getTitle() const override {
         return "Pattern Functions Demo";
     }
 
@@ -278,7 +297,7 @@ public:
         // Page title
         display.setFont(&FreeMonoBold18pt7b);
         display.setCursor(20, 40);
-        display.print(getTitle());
+        display.print(getTitle().c_str());
         
         // Simple pattern demos
         drawPatternSamples(epd);
@@ -444,10 +463,20 @@ private:
 
     // Operating mode
     size_t modeIndex = 0;
-    std::vector<String> modes = {"Normal", "Eco", "Performance", "Custom"};
+    // Static option table: the dropdown views it in flash, no heap copy of the texts
+    static constexpr const char *MODES[] = {"Normal", "Eco", "Performance", "Custom"};
+
+    // Kept as members so rendering the page does not allocate
+    ComponentProgressBar cpuBar{"CPU Load", cpuLoad};
+    ComponentProgressBar ramBar{"RAM Usage", ramUsage};
+    ComponentProgressBar diskBar{"Disk Usage", diskUsage};
+    ComponentProgressBar temperatureBar{"Temperature", temperature};
 
 public:
     DemoPage() : Page() {
+        // The widgets share one arena block that is freed with the page
+        enableArena(1024);
+
         // System controls
         /*addInteractable(
             std::make_unique<InteractableToggle>(
@@ -457,40 +486,34 @@ public:
             )
         );*/
 
-        addInteractable(
-            std::make_unique<InteractableDropdown>(
-                "operating_mode",
-                "Operating Mode",
-                modes,
-                &modeIndex
-            )
+        emplaceInteractable<InteractableDropdown>(
+            "operating_mode",
+            "Operating Mode",
+            MODES,
+            &modeIndex
         );
 
         // Display settings
-        addInteractable(
-            std::make_unique<InteractableSlider>(
-                "brightness",
-                "Brightness",
-                &brightnessValue,
-                0,
-                255,
-                15
-            )
+        emplaceInteractable<InteractableSlider>(
+            "brightness",
+            "Brightness",
+            &brightnessValue,
+            0,
+            255,
+            15
         );
 
-        addInteractable(
-            std::make_unique<InteractableSlider>(
-                "contrast",
-                "Contrast",
-                &contrastValue,
-                0,
-                255,
-                30
-            )
+        emplaceInteractable<InteractableSlider>(
+            "contrast",
+            "Contrast",
+            &contrastValue,
+            0,
+            255,
+            30
         );
     }
 
-    [[nodiscard]] String getTitle() const override {
+    [[nodiscard]] StringRef getTitle() const override {
         return "System Settings";
     }
 
@@ -502,7 +525,7 @@ public:
         // Header
         display.setFont(&FreeMonoBold18pt7b);
         display.setCursor(leftCol, 40);
-        display.print(getTitle());
+        display.print(getTitle().c_str());
 
         // System controls
         //getInteractable("sys_power")->executeRender(epd, RenderContext{leftCol, 80}); // Power toggle
@@ -521,28 +544,10 @@ public:
         display.print("System Status");
 
 
-        std::make_unique<ComponentProgressBar>(
-            "CPU Load",
-            cpuLoad
-        )->executeRender(epd, RenderContext{leftCol, 410});
-
-
-        std::make_unique<ComponentProgressBar>(
-            "RAM Usage",
-            ramUsage
-        )->executeRender(epd, RenderContext{rightCol, 410});
-
-
-        std::make_unique<ComponentProgressBar>(
-            "Disk Usage",
-            diskUsage
-        )->executeRender(epd, RenderContext{leftCol, 460});
-
-
-        std::make_unique<ComponentProgressBar>(
-            "Temperature",
-            temperature
-        )->executeRender(epd, RenderContext{rightCol, 460});
+        cpuBar.executeRender(epd, RenderContext{leftCol, 410});
+        ramBar.executeRender(epd, RenderContext{rightCol, 410});
+        diskBar.executeRender(epd, RenderContext{leftCol, 460});
+        temperatureBar.executeRender(epd, RenderContext{rightCol, 460});
 
         getInteractable("operating_mode")->executeRender(epd, RenderContext{leftCol, 130}); // Mode dropdown
     }
@@ -550,7 +555,7 @@ public:
 
 class SettingsPage : public Page {
 public:
-    [[nodiscard]] String getTitle() const {
+    [[nodiscard]] StringRef getTitle() const {
         return "Settings";
     }
 
@@ -561,7 +566,7 @@ public:
         // Header
         display.setFont(&FreeMonoBold18pt7b);
         display.setCursor(20, 40);
-        display.print(getTitle());
+        display.print(getTitle().c_str());
 
         // Settings menu
         drawSettingsMenu(epd);
@@ -644,7 +649,7 @@ private:
 
 class SensorDashboardPage : public Page {
 public:
-    [[nodiscard]] String getTitle() const {
+    [[nodiscard]] StringRef getTitle() const {
         return "Sensor Data";
     }
 
@@ -655,7 +660,7 @@ public:
         // Header
         display.setFont(&FreeMonoBold18pt7b);
         display.setCursor(20, 40);
-        display.print(getTitle());
+        display.print(getTitle().c_str());
 
         // Draw sensor readings
         drawSensorGrid(epd);
@@ -691,7 +696,7 @@ private:
 
                 display.setFont(&FreeMonoBold12pt7b);
                 display.setCursor(x + 10, y + 60);
-                display.print(String(random(100)) + " " + (row * 2 + col == 0 ? "°C" : "%"));
+                display.printf("%ld %s", random(100), row * 2 + col == 0 ? "°C" : "%");
             }
         }
     }
@@ -746,7 +751,7 @@ class TextDemoPage : public Page {
 public:
     TextDemoPage() : Page() {}
 
-    [[nodiscard]] String getTitle() const override {
+    [[nodiscard]] StringRef getTitle() const override {
         return "Text Alignment Demo";
     }
 
@@ -756,7 +761,7 @@ public:
         // Page title
         display.setFont(&FreeMonoBold18pt7b);
         display.setCursor(20, 40);
-        display.print(getTitle());
+        display.print(getTitle().c_str());
 
         // Show the different text alignment methods
         drawRegularTextDemo(epd);
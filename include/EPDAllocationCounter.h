@@ -0,0 +1,70 @@
+#ifndef EPDALLOCATIONCOUNTER_H
+#define EPDALLOCATIONCOUNTER_H
+
+/**
+ * @file EPDAllocationCounter.h
+ * Counts heap allocations, e.g. to check that a render allocates nothing.
+ *
+ * Counting is opt-in. Build with
+ *   -DGXUI_COUNT_ALLOCATIONS -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+ * and every malloc, calloc and realloc in the firmware (operator new and
+ * Arduino String included) goes through the wrappers below. The counter is
+ * global, so allocations of other tasks show up as well. Without the flag
+ * isEnabled() is false and the count stays 0.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace EPD {
+    class AllocationCounter {
+    public:
+        [[nodiscard]] static constexpr bool isEnabled() {
+#ifdef GXUI_COUNT_ALLOCATIONS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /** Allocations since boot; subtract two readings to count a section. */
+        [[nodiscard]] static uint32_t get() {
+            return count().load(std::memory_order_relaxed);
+        }
+
+        static void record() {
+            count().fetch_add(1, std::memory_order_relaxed);
+        }
+
+    private:
+        static std::atomic<uint32_t> &count() {
+            static std::atomic<uint32_t> allocations{0};
+            return allocations;
+        }
+    };
+}
+
+#ifdef GXUI_COUNT_ALLOCATIONS
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(const size_t size) {
+    EPD::AllocationCounter::record();
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(const size_t count, const size_t size) {
+    EPD::AllocationCounter::record();
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, const size_t size) {
+    EPD::AllocationCounter::record();
+    return __real_realloc(pointer, size);
+}
+}
+#endif
+#endif //EPDALLOCATIONCOUNTER_H
@@ -0,0 +1,128 @@
+#ifndef EPDARENA_H
+#define EPDARENA_H
+
+/**
+ * @file EPDArena.h
+ * Monotonic arena for objects that share one lifetime, e.g. the widgets of
+ * a page.
+ *
+ * Memory is taken from chunks of a fixed size that are only handed back
+ * all at once, when the arena is released or destroyed. Objects are never
+ * freed individually, so a page that is opened and closed repeatedly leaves
+ * a few large holes in the heap instead of many small ones. Destructors are
+ * not run by the arena; owners destroy what they created before releasing.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace EPD {
+    class Arena {
+        struct Chunk {
+            Chunk *next;
+            size_t size;
+        };
+
+        Chunk *chunks = nullptr;
+        uint8_t *cursor = nullptr;
+        uint8_t *end = nullptr;
+        size_t chunkSize;
+
+        size_t used = 0;
+        size_t reserved = 0;
+        size_t highWaterMark = 0;
+
+    public:
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 2048;
+
+        explicit Arena(const size_t chunkSize = DEFAULT_CHUNK_SIZE) : chunkSize(chunkSize) {
+        }
+
+        Arena(const Arena &) = delete;
+
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() {
+            release();
+        }
+
+        /**
+         * Uninitialized memory for size bytes. Requests larger than a chunk
+         * get a chunk of their own.
+         * @return nullptr if the heap is exhausted
+         */
+        void *allocate(const size_t size, const size_t align = alignof(std::max_align_t)) {
+            uint8_t *aligned = alignUp(cursor, align);
+            if (cursor == nullptr || aligned + size > end) {
+                if (!grow(size + align)) return nullptr;
+                aligned = alignUp(cursor, align);
+            }
+
+            used += aligned + size - cursor;
+            cursor = aligned + size;
+            if (used > highWaterMark) highWaterMark = used;
+            return aligned;
+        }
+
+        /** Construct a T in the arena; its destructor is up to the caller. */
+        template<typename T, typename... Args>
+        T *create(Args &&... args) {
+            void *memory = allocate(sizeof(T), alignof(T));
+            return memory != nullptr ? new(memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        /** Hand all chunks back to the heap. Objects in the arena must be destroyed already. */
+        void release() {
+            while (chunks != nullptr) {
+                Chunk *next = chunks->next;
+                free(chunks);
+                chunks = next;
+            }
+            cursor = nullptr;
+            end = nullptr;
+            used = 0;
+            reserved = 0;
+        }
+
+        /** Bytes handed out, including alignment padding. */
+        [[nodiscard]] size_t getUsedBytes() const {
+            return used;
+        }
+
+        /** Bytes taken from the heap for chunks. */
+        [[nodiscard]] size_t getReservedBytes() const {
+            return reserved;
+        }
+
+        /** Most bytes ever handed out at once, kept across release(). Useful to size the chunks. */
+        [[nodiscard]] size_t getHighWaterMark() const {
+            return highWaterMark;
+        }
+
+    private:
+        static uint8_t *alignUp(uint8_t *pointer, const size_t align) {
+            const uintptr_t value = reinterpret_cast<uintptr_t>(pointer);
+            return reinterpret_cast<uint8_t *>((value + align - 1) & ~(static_cast<uintptr_t>(align) - 1));
+        }
+
+        bool grow(const size_t minimum) {
+            const size_t size = sizeof(Chunk) + (minimum > chunkSize ? minimum : chunkSize);
+            auto *chunk = static_cast<Chunk *>(malloc(size));
+            if (chunk == nullptr) return false;
+
+            chunk->next = chunks;
+            chunk->size = size;
+            chunks = chunk;
+            reserved += size;
+
+            // The rest of the previous chunk is left unused
+            cursor = reinterpret_cast<uint8_t *>(chunk + 1);
+            end = reinterpret_cast<uint8_t *>(chunk) + size;
+            return true;
+        }
+    };
+}
+#endif //EPDARENA_H
@@ -0,0 +1,140 @@
+#ifndef EPDCALLBACK_H
+#define EPDCALLBACK_H
+
+/**
+ * @file EPDCallback.h
+ * Move-only callable with inline storage for widget callbacks.
+ *
+ * EPD::Callback<R(Args...), Capacity> stores the callable in a buffer of
+ * Capacity bytes inside the object, so binding a lambda never allocates.
+ * A callable that does not fit fails to compile with a static_assert
+ * instead of silently falling back to the heap. Calls go through a single
+ * function pointer; calling an empty callback is a no-op.
+ *
+ * The default capacity holds a few pointers (e.g. [this] plus some
+ * references); define GXUI_CALLBACK_CAPACITY before including GXUI to
+ * change it for all widgets.
+ */
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef GXUI_CALLBACK_CAPACITY
+#define GXUI_CALLBACK_CAPACITY (4 * sizeof(void *))
+#endif
+
+namespace EPD {
+    template<typename Signature, size_t Capacity = GXUI_CALLBACK_CAPACITY>
+    class Callback;
+
+    template<typename R, typename... Args, size_t Capacity>
+    class Callback<R(Args...), Capacity> {
+        /** Per callable type: call, move into other storage (destroying the source) and destroy. */
+        struct Operations {
+            R (*invoke)(void *storage, Args &&... args);
+            void (*relocate)(void *from, void *to);
+            void (*destroy)(void *storage);
+        };
+
+        template<typename F>
+        static const Operations *operationsFor() {
+            static constexpr Operations operations{
+                [](void *storage, Args &&... args) -> R {
+                    return (*static_cast<F *>(storage))(std::forward<Args>(args)...);
+                },
+                [](void *from, void *to) {
+                    new(to) F(std::move(*static_cast<F *>(from)));
+                    static_cast<F *>(from)->~F();
+                },
+                [](void *storage) {
+                    static_cast<F *>(storage)->~F();
+                },
+            };
+            return &operations;
+        }
+
+        alignas(std::max_align_t) mutable unsigned char storage[Capacity];
+        const Operations *operations = nullptr;
+
+    public:
+        static constexpr size_t CAPACITY = Capacity;
+
+        Callback() = default;
+
+        Callback(std::nullptr_t) {
+        }
+
+        template<typename F, typename Fn = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same_v<Fn, Callback> && std::is_invocable_r_v<R, Fn &, Args...> > >
+        Callback(F &&callable) {
+            static_assert(sizeof(Fn) <= Capacity,
+                          "Callable does not fit the inline storage of EPD::Callback; capture less or raise the capacity");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t), "Over-aligned callables are not supported");
+
+            if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn>) {
+                if (callable == nullptr) return;
+            }
+            new(storage) Fn(std::forward<F>(callable));
+            operations = operationsFor<Fn>();
+        }
+
+        Callback(Callback &&other) noexcept {
+            moveFrom(other);
+        }
+
+        Callback &operator=(Callback &&other) noexcept {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        Callback &operator=(std::nullptr_t) {
+            reset();
+            return *this;
+        }
+
+        Callback(const Callback &) = delete;
+
+        Callback &operator=(const Callback &) = delete;
+
+        ~Callback() {
+            reset();
+        }
+
+        explicit operator bool() const {
+            return operations != nullptr;
+        }
+
+        /**
+         * Call the stored callable. Widgets take nullptr for "no callback",
+         * so calling an empty one does nothing and returns R() (false for bool).
+         */
+        R operator()(Args... args) const {
+            if (operations == nullptr) {
+                return R();
+            }
+            return operations->invoke(storage, std::forward<Args>(args)...);
+        }
+
+        void reset() {
+            if (operations != nullptr) {
+                operations->destroy(storage);
+                operations = nullptr;
+            }
+        }
+
+    private:
+        void moveFrom(Callback &other) {
+            if (other.operations != nullptr) {
+                other.operations->relocate(other.storage, storage);
+                operations = other.operations;
+                other.operations = nullptr;
+            }
+        }
+    };
+}
+#endif //EPDCALLBACK_H
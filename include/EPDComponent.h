@@ -11,43 +11,49 @@
 
 namespace EPD {
     class Component : public Renderable {
+    protected:
+        /** Components are placed on the layout grid so their partial windows stay byte aligned. */
+        [[nodiscard]] bool isGridAligned() const override {
+            return true;
+        }
     };
 
     class ComponentProgressBar : public Component {
-        String label{};
+        Label label{};
         float progress; // 0.0 to 1.0
         bool printPercentage{false};
 
         static constexpr int PADDING = 12;
         static constexpr int BAR_HEIGHT = 24;
         static constexpr int BORDER_RADIUS = 4;
+        static constexpr int BAR_WIDTH = 128;
+        static constexpr int PERCENTAGE_MARGIN = 8;
+
+        uint16_t labelHeight = 0;
 
     public:
-        ComponentProgressBar(const String &label, float progress, const bool printPercentage = false)
+        ComponentProgressBar(const StringRef label, float progress, const bool printPercentage = false)
             : label(label), progress(progress), printPercentage(printPercentage) {
             this->progress = std::clamp(progress, 0.0f, 1.0f);
         }
 
+        Size onMeasure(Controller &epd, const Size &available) override {
+            const uint16_t labelH = epd.measureText(label, &FreeMonoBold12pt7b).h;
+            labelHeight = labelH;
+
+            return {BAR_WIDTH + PADDING * 2, labelH + BAR_HEIGHT + PERCENTAGE_MARGIN + PADDING * 2};
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             auto &display = epd.getDisplay();
             display.setFont(&FreeMonoBold12pt7b);
 
-            int16_t x1, y1;
-            uint16_t labelW, labelH;
-            display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &labelW, &labelH);
-
-            constexpr int BAR_WIDTH = 128;
-            constexpr int PERCENTAGE_MARGIN = 8;
-
-            ctx.x = (x1 + 7) & ~7;
-            ctx.y = (y1 + 7) & ~7;
-            ctx.width = (BAR_WIDTH + PADDING * 2 + 7) & ~7;
-            ctx.height = (labelH + BAR_HEIGHT + PERCENTAGE_MARGIN + PADDING * 2 + 7) & ~7;
+            const uint16_t labelH = labelHeight;
 
             // Draw label
             display.setTextColor(epd.getPrimaryColor());
             display.setCursor(ctx.x + PADDING, ctx.y + labelH + PADDING);
-            display.print(label);
+            display.print(label.c_str());
 
             // Draw progress bar
             const int barX = ctx.x + PADDING;
@@ -74,9 +80,9 @@ namespace EPD {
                 // Draw percentage
                 char percentage[8];
                 snprintf(percentage, sizeof(percentage), "%d%%", static_cast<int>(progress * 100));
-                int16_t percX1, percY1;
-                uint16_t percW, percH;
-                display.getTextBounds(percentage, 0, 0, &percX1, &percY1, &percW, &percH);
+                const Controller::Bounds percBounds = epd.measureText(percentage, &FreeMonoBold12pt7b);
+                const uint16_t percW = percBounds.w;
+                const uint16_t percH = percBounds.h;
                 display.setCursor(barX + (BAR_WIDTH - percW) / 2, barY + BAR_HEIGHT + PERCENTAGE_MARGIN + percH);
                 display.print(percentage);
             }
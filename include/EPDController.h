@@ -10,12 +10,13 @@
  * instance for convenient access across the UI.
  */
 
-#include <GxEPD2_4G_BW.h>
-#include <gdey/GxEPD2_750_GDEY075T7.h>
 #include <Preferences.h>
 #include <SPI.h>
 
 #include "../../../include/fonts/fonts.h"
+#include "EPDDisplay.h"
+#include "EPDFontMetrics.h"
+#include "EPDString.h"
 
 #define DISPLAY_THEME_KEY "display_theme"
 
@@ -52,6 +53,9 @@ namespace EPD {
             display.setRotation(
                 3
             );
+#ifdef GXUI_SHADOW_FRAME
+            display.enableShadowFrame();
+#endif
             display.setFont(
                 &FreeMono18pt7b
             );
@@ -59,7 +63,7 @@ namespace EPD {
         }
 
 
-        [[nodiscard]] GxEPD2_4G_BW<GxEPD2_750_GDEY075T7, GxEPD2_750_GDEY075T7::HEIGHT> &getDisplay() {
+        [[nodiscard]] Display &getDisplay() {
             return display;
         }
 
@@ -175,6 +179,52 @@ namespace EPD {
             }
         }
 
+        /**
+         * Draw a 2bpp bitmap: 4 pixels per byte, MSB first, rows padded to
+         * whole bytes, 0 blank up to 3 full color. The middle levels become
+         * grays between the background and color while a full window is set;
+         * under a fast partial refresh the bitmap is thresholded to 1bpp.
+         */
+        void drawGrayBitmap(
+            const int x,
+            const int y,
+            const unsigned char *bitmap,
+            const int width,
+            const int height,
+            const uint16_t color = GxEPD_BLACK
+        ) {
+            const bool gray = display.isGrayscaleWindow();
+            const bool inverted = color == GxEPD_WHITE;
+            const uint16_t colors[4] = {
+                0,
+                static_cast<uint16_t>(inverted ? GxEPD_DARKGREY : GxEPD_LIGHTGREY),
+                static_cast<uint16_t>(inverted ? GxEPD_LIGHTGREY : GxEPD_DARKGREY),
+                color
+            };
+            const int rowBytes = (width + 3) / 4;
+
+            // One horizontal line per run of equal levels
+            for (int row = 0; row < height; row++) {
+                const unsigned char *bytes = bitmap + row * rowBytes;
+                int runStart = 0;
+                int runLevel = 0;
+                for (int px = 0; px <= width; px++) {
+                    int level = 0;
+                    if (px < width) {
+                        level = (pgm_read_byte(bytes + px / 4) >> (6 - (px % 4) * 2)) & 0x03;
+                        if (!gray) level = level >= 2 ? 3 : 0;
+                    }
+                    if (px < width && level == runLevel) continue;
+
+                    if (runLevel != 0) {
+                        display.drawFastHLine(x + runStart, y + row, px - runStart, colors[runLevel]);
+                    }
+                    runStart = px;
+                    runLevel = level;
+                }
+            }
+        }
+
         // following helper functions by Rukenshia/pomodoro :) too good not to use
         enum class Pattern {
             SOLID,
@@ -276,7 +326,40 @@ namespace EPD {
             }
         }
 
-        Bounds getBounds(const char *text, const GFXfont *font) {
+        /**
+         * Bounds of text drawn at (0, 0), like getTextBounds. Monospaced fonts
+         * take a fast path that returns advance bounds rather than the ink of
+         * the glyphs: the longest line's length * advance wide and
+         * ascent + descent high, plus the font's line advance for every line
+         * down to the last one with text, so strings of equal length measure
+         * equal.
+         */
+        Bounds measureText(const char *text, const size_t length, const GFXfont *font) {
+            if (const FontMetrics &metrics = FontMetrics::of(font); metrics.isMonospace()) {
+                size_t longest = length;
+                size_t lastLine = 0;
+                if (memchr(text, '\n', length) != nullptr) {
+                    longest = 0;
+                    size_t line = 0;
+                    size_t lineStart = 0;
+                    for (size_t i = 0; i <= length; i++) {
+                        if (i < length && text[i] != '\n') continue;
+                        if (i > lineStart) {
+                            longest = std::max(longest, i - lineStart);
+                            lastLine = line;
+                        }
+                        line++;
+                        lineStart = i + 1;
+                    }
+                }
+                return {
+                    0,
+                    static_cast<int16_t>(-metrics.ascent),
+                    metrics.textWidth(longest),
+                    static_cast<uint16_t>(metrics.lineHeight() + lastLine * font->yAdvance)
+                };
+            }
+
             display.setTextSize(1);
             display.setFont(font);
 
@@ -287,6 +370,22 @@ namespace EPD {
             return {x1, y1, w, h};
         }
 
+        Bounds measureText(const char *text, const GFXfont *font) {
+            return measureText(text, strlen(text), font);
+        }
+
+        Bounds measureText(const String &text, const GFXfont *font) {
+            return measureText(text.c_str(), text.length(), font);
+        }
+
+        Bounds measureText(const StringRef text, const GFXfont *font) {
+            return measureText(text.c_str(), text.length(), font);
+        }
+
+        Bounds getBounds(const char *text, const GFXfont *font) {
+            return measureText(text, font);
+        }
+
         Bounds drawText(
             const char *text,
             int16_t x,
@@ -298,9 +397,9 @@ namespace EPD {
             display.setFont(font);
             display.setTextColor(color);
 
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+            const Bounds bounds = measureText(text, font);
+            const uint16_t w = bounds.w;
+            const uint16_t h = bounds.h;
             display.setCursor(x, y);
             display.print(text);
 
@@ -318,9 +417,9 @@ namespace EPD {
             display.setFont(font);
             display.setTextColor(color);
 
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+            const Bounds bounds = measureText(text, font);
+            const uint16_t w = bounds.w;
+            const uint16_t h = bounds.h;
             display.setCursor(x, y + h);
             display.print(text);
 
@@ -338,9 +437,10 @@ namespace EPD {
             display.setFont(font);
             display.setTextColor(color);
 
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+            const Bounds bounds = measureText(text, font);
+            const int16_t y1 = bounds.y;
+            const uint16_t w = bounds.w;
+            const uint16_t h = bounds.h;
             // Correct the y coordinate considering y1 offset (usually negative)
             int16_t correctedY = y - h / 2 - y1;
 
@@ -408,7 +508,7 @@ namespace EPD {
         ) = delete;
 
         // Member variable for the display
-        GxEPD2_4G_BW<GxEPD2_750_GDEY075T7, GxEPD2_750_GDEY075T7::HEIGHT> display;
+        Display display;
 
         // New preferences pointer for settings
         Preferences *preferences;
@@ -0,0 +1,450 @@
+#ifndef EPDDISPLAY_H
+#define EPDDISPLAY_H
+
+/**
+ * @file EPDDisplay.h
+ * The GxEPD2 display used by GXUI, with direct rectangle fills and a shadow frame.
+ *
+ * EPD::Display is the GxEPD2 4-gray driver with two additions:
+ *  - GxEPD2 only implements drawPixel, so Adafruit_GFX draws lines and
+ *    rectangles through writeLine, a virtual drawPixel call per pixel that
+ *    also maps each pixel into the shadow frame. fillRect and the fast
+ *    lines are overridden to write the page buffer directly and the shadow
+ *    a byte at a time.
+ *  - An optional shadow frame mirrors what the panel shows as a native 1bpp
+ *    bitmap. GxEPD2 reuses its buffer for each partial window and keeps it
+ *    private, so the shadow is the only place regions of the screen can be
+ *    read back from, e.g. to save and restore the area under an overlay.
+ */
+
+#include <GxEPD2_4G_BW.h>
+#include <gdey/GxEPD2_750_GDEY075T7.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "EPDRenderable.h"
+
+namespace EPD {
+    class Display : public GxEPD2_4G_BW<GxEPD2_750_GDEY075T7, GxEPD2_750_GDEY075T7::HEIGHT> {
+    public:
+        using Base = GxEPD2_4G_BW<GxEPD2_750_GDEY075T7, GxEPD2_750_GDEY075T7::HEIGHT>;
+        using Base::Base;
+
+        /** Rectangle in native panel coordinates. */
+        struct NativeRect {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+        };
+
+        /** A saved part of the shadow frame, byte-aligned in native coordinates. */
+        struct FrameRegion {
+            int16_t x = 0;      ///< native x, multiple of 8
+            int16_t y = 0;
+            int16_t width = 0;  ///< native width, multiple of 8
+            int16_t height = 0;
+            std::vector<uint8_t> bits{};
+
+            [[nodiscard]] bool isEmpty() const {
+                return width <= 0 || height <= 0;
+            }
+        };
+
+        /**
+         * Allocate the shadow frame (WIDTH * HEIGHT / 8 bytes, PSRAM if
+         * available). Everything drawn from now on is mirrored into it, so
+         * enable it before the first full render.
+         */
+        bool enableShadowFrame() {
+            if (shadow != nullptr) return true;
+
+            const size_t size = FRAME_SIZE;
+            void *memory = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (memory == nullptr) {
+                memory = malloc(size);
+            }
+            if (memory == nullptr) {
+                Serial.println("Display: not enough memory for the shadow frame");
+                return false;
+            }
+
+            shadow.reset(static_cast<uint8_t *>(memory));
+            memset(shadow.get(), 0xFF, size);
+            return true;
+        }
+
+        [[nodiscard]] bool hasShadowFrame() const {
+            return shadow != nullptr;
+        }
+
+        /**
+         * Whether the current pass ends in a full refresh, the only one that
+         * shows gray levels; a fast partial refresh is black and white.
+         */
+        [[nodiscard]] bool isGrayscaleWindow() const {
+            return fullWindow;
+        }
+
+        void setFullWindow() {
+            Base::setFullWindow();
+            window = NativeRect{0, 0, WIDTH, HEIGHT};
+            fullWindow = true;
+        }
+
+        void setPartialWindow(const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) {
+            Base::setPartialWindow(x, y, w, h);
+            fullWindow = false;
+
+            // Same clamping and byte alignment GxEPD2 applies to its window
+            const int px = std::min<int>(x, width());
+            const int py = std::min<int>(y, height());
+            window = alignedNativeRect(RenderContext(
+                px, py, std::min<int>(w, width() - px), std::min<int>(h, height() - py)));
+        }
+
+        void drawPixel(const int16_t x, const int16_t y, const uint16_t color) override {
+            Base::drawPixel(x, y, color);
+            if (shadow == nullptr || x < 0 || y < 0 || x >= width() || y >= height()) return;
+
+            int nx, ny;
+            toNative(x, y, nx, ny);
+            if (nx < window.x || ny < window.y || nx >= window.x + window.width || ny >= window.y + window.height) {
+                return;
+            }
+            uint8_t &byte = shadow[ny * STRIDE + nx / 8];
+            if (color == GxEPD_WHITE) {
+                byte |= 0x80 >> (nx % 8);
+            } else {
+                byte &= ~(0x80 >> (nx % 8));
+            }
+        }
+
+        void drawFastHLine(const int16_t x, const int16_t y, const int16_t w, const uint16_t color) override {
+            fillRect(x, y, w, 1, color);
+        }
+
+        void drawFastVLine(const int16_t x, const int16_t y, const int16_t h, const uint16_t color) override {
+            fillRect(x, y, 1, h, color);
+        }
+
+        void fillRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, const uint16_t color) override {
+            const int x0 = std::max<int>(x, 0);
+            const int y0 = std::max<int>(y, 0);
+            const int x1 = std::min<int>(x + w, width());
+            const int y1 = std::min<int>(y + h, height());
+            if (x0 >= x1 || y0 >= y1) return;
+
+            fillPanelRect(x0, y0, x1, y1, color);
+            if (shadow != nullptr) {
+                fillShadowRect(nativeRect(RenderContext(x0, y0, x1 - x0, y1 - y0)), color == GxEPD_WHITE);
+            }
+        }
+
+        void fillScreen(const uint16_t color) override {
+            Base::fillScreen(color);
+            if (shadow == nullptr) return;
+
+            for (int ny = window.y; ny < window.y + window.height; ny++) {
+                memset(shadow.get() + ny * STRIDE + window.x / 8, color == GxEPD_WHITE ? 0xFF : 0x00, window.width / 8);
+            }
+        }
+
+        /**
+         * Copy the shadow frame under a logical rectangle. The region is
+         * widened to whole bytes in native orientation.
+         * @return false without a shadow frame or for an empty area
+         */
+        bool captureRegion(const RenderContext &area, FrameRegion &out) const {
+            out.bits.clear();
+            if (shadow == nullptr) return false;
+
+            const NativeRect rect = alignedNativeRect(area);
+            out.x = static_cast<int16_t>(rect.x);
+            out.y = static_cast<int16_t>(rect.y);
+            out.width = static_cast<int16_t>(rect.width);
+            out.height = static_cast<int16_t>(rect.height);
+            if (out.isEmpty()) return false;
+
+            const int rowBytes = out.width / 8;
+            out.bits.resize(static_cast<size_t>(rowBytes) * out.height);
+            for (int row = 0; row < out.height; row++) {
+                memcpy(out.bits.data() + row * rowBytes, shadow.get() + (out.y + row) * STRIDE + out.x / 8, rowBytes);
+            }
+            return true;
+        }
+
+        /**
+         * Draw a captured region back, limited to the current window. Call it
+         * from a paged render callback; no widget render code runs for it.
+         */
+        void restoreRegion(const FrameRegion &region) {
+            if (shadow == nullptr) return;
+
+            const int x0 = std::max<int>(region.x, window.x);
+            const int y0 = std::max<int>(region.y, window.y);
+            const int x1 = std::min<int>(region.x + region.width, window.x + window.width);
+            const int y1 = std::min<int>(region.y + region.height, window.y + window.height);
+            if (x0 >= x1 || y0 >= y1) return;
+
+            const int rowBytes = region.width / 8;
+            for (int ny = y0; ny < y1; ny++) {
+                const uint8_t *row = region.bits.data() + (ny - region.y) * rowBytes;
+                memcpy(shadow.get() + ny * STRIDE + x0 / 8, row + (x0 - region.x) / 8, (x1 - x0) / 8);
+            }
+            drawFromShadow(NativeRect{x0, y0, x1 - x0, y1 - y0});
+        }
+
+        /** Bytes of a whole native frame as kept in the shadow frame. */
+        static constexpr size_t FRAME_SIZE =
+            static_cast<size_t>(GxEPD2_750_GDEY075T7::WIDTH / 8) * GxEPD2_750_GDEY075T7::HEIGHT;
+
+        /** The shadow frame, FRAME_SIZE bytes, or nullptr without one. */
+        [[nodiscard]] const uint8_t *getShadowFrame() const {
+            return shadow.get();
+        }
+
+        /**
+         * Overwrite the shadow frame through fill(frame, FRAME_SIZE) and draw
+         * the current window from it, e.g. to show a cached screen without
+         * running any render code. fill must leave the frame untouched when
+         * it fails, so the shadow frame keeps mirroring the panel.
+         * @return false without a shadow frame or if fill failed
+         */
+        template<typename Fill>
+        bool loadFrame(Fill &&fill) {
+            if (shadow == nullptr || !fill(shadow.get(), FRAME_SIZE)) return false;
+            drawFromShadow(window);
+            return true;
+        }
+
+        /**
+         * Shift a captured region by a logical offset, e.g. rows of a list that
+         * scrolled, so restoreRegion draws it at its new place. The offset has
+         * to be a multiple of 8 to keep the region byte-aligned.
+         */
+        void moveRegion(FrameRegion &region, const int dx, const int dy) const {
+            const RenderContext bounds = logicalBounds(region);
+            const NativeRect rect = nativeRect(RenderContext(bounds.x + dx, bounds.y + dy, bounds.width, bounds.height));
+            region.x = static_cast<int16_t>(rect.x);
+            region.y = static_cast<int16_t>(rect.y);
+        }
+
+        /** Logical rectangle covered by a captured region. */
+        [[nodiscard]] RenderContext logicalBounds(const FrameRegion &region) const {
+            return logicalRect(NativeRect{region.x, region.y, region.width, region.height});
+        }
+
+        /**
+         * Logical rectangle of the current window. A partial window is widened
+         * to whole bytes in native orientation, so it can be larger than the
+         * rectangle passed to setPartialWindow.
+         */
+        [[nodiscard]] RenderContext getWindowBounds() const {
+            return logicalRect(window);
+        }
+
+    private:
+        static constexpr int STRIDE = GxEPD2_750_GDEY075T7::WIDTH / 8;
+
+        std::unique_ptr<uint8_t[], void (*)(void *)> shadow{nullptr, free};
+        NativeRect window{0, 0, GxEPD2_750_GDEY075T7::WIDTH, GxEPD2_750_GDEY075T7::HEIGHT};
+        bool fullWindow = true;
+
+        /** Logical rectangle of a native one. */
+        [[nodiscard]] RenderContext logicalRect(const NativeRect &rect) const {
+            const int W = WIDTH;
+            const int H = HEIGHT;
+            switch (getRotation() & 3) {
+                case 1:
+                    return RenderContext(rect.y, W - rect.x - rect.width, rect.height, rect.width);
+                case 2:
+                    return RenderContext(W - rect.x - rect.width, H - rect.y - rect.height, rect.width, rect.height);
+                case 3:
+                    return RenderContext(H - rect.y - rect.height, rect.x, rect.height, rect.width);
+                case 0:
+                default:
+                    return RenderContext(rect.x, rect.y, rect.width, rect.height);
+            }
+        }
+
+        /** Logical to native pixel, the mapping GxEPD2 applies in drawPixel. */
+        void toNative(const int x, const int y, int &nx, int &ny) const {
+            switch (getRotation() & 3) {
+                case 1:
+                    nx = WIDTH - 1 - y;
+                    ny = x;
+                    break;
+                case 2:
+                    nx = WIDTH - 1 - x;
+                    ny = HEIGHT - 1 - y;
+                    break;
+                case 3:
+                    nx = y;
+                    ny = HEIGHT - 1 - x;
+                    break;
+                case 0:
+                default:
+                    nx = x;
+                    ny = y;
+                    break;
+            }
+        }
+
+        void toLogical(const int nx, const int ny, int &x, int &y) const {
+            switch (getRotation() & 3) {
+                case 1:
+                    x = ny;
+                    y = WIDTH - 1 - nx;
+                    break;
+                case 2:
+                    x = WIDTH - 1 - nx;
+                    y = HEIGHT - 1 - ny;
+                    break;
+                case 3:
+                    x = HEIGHT - 1 - ny;
+                    y = nx;
+                    break;
+                case 0:
+                default:
+                    x = nx;
+                    y = ny;
+                    break;
+            }
+        }
+
+        /**
+         * Draw a native rectangle of the shadow frame to the page buffer, one
+         * rectangle per run of equal pixels. Whole bytes that continue a run
+         * are skipped without looking at their bits. When the rectangle is
+         * the whole window, as for an overlay or a cached frame, GxEPD2's
+         * fillScreen (a memset) paints the more frequent color first and only
+         * runs of the other color are drawn.
+         */
+        void drawFromShadow(const NativeRect &rect) {
+            int background = -1; // 1 white, 0 black, -1 both colors are drawn
+            if (rect.x == window.x && rect.y == window.y && rect.width == window.width &&
+                rect.height == window.height) {
+                size_t whitePixels = 0;
+                for (int ny = rect.y; ny < rect.y + rect.height; ny++) {
+                    const uint8_t *row = shadow.get() + ny * STRIDE + rect.x / 8;
+                    for (int k = 0; k < rect.width / 8; k++) {
+                        whitePixels += __builtin_popcount(row[k]);
+                    }
+                }
+                background = whitePixels * 2 >= static_cast<size_t>(rect.width) * rect.height ? 1 : 0;
+                Base::fillScreen(background == 1 ? GxEPD_WHITE : GxEPD_BLACK);
+            }
+
+            const auto drawRun = [&](const int nx, const int ny, const int length, const bool white) {
+                if (background != static_cast<int>(white)) {
+                    fillPanelRun(nx, ny, length, white ? GxEPD_WHITE : GxEPD_BLACK);
+                }
+            };
+            const int end = rect.x + rect.width;
+            for (int ny = rect.y; ny < rect.y + rect.height; ny++) {
+                const uint8_t *row = shadow.get() + ny * STRIDE;
+                int runStart = rect.x;
+                bool runWhite = row[rect.x / 8] & (0x80 >> (rect.x % 8));
+                for (int nx = rect.x; nx < end;) {
+                    if (nx % 8 == 0 && nx + 8 <= end && row[nx / 8] == (runWhite ? 0xFF : 0x00)) {
+                        nx += 8;
+                        continue;
+                    }
+                    if (static_cast<bool>(row[nx / 8] & (0x80 >> (nx % 8))) != runWhite) {
+                        drawRun(runStart, ny, nx - runStart, runWhite);
+                        runStart = nx;
+                        runWhite = !runWhite;
+                    }
+                    nx++;
+                }
+                drawRun(runStart, ny, end - runStart, runWhite);
+            }
+        }
+
+        /** Native rectangle of a logical one, clipped to the panel. */
+        [[nodiscard]] NativeRect nativeRect(const RenderContext &area) const {
+            if (area.isEmpty()) return NativeRect{};
+
+            int ax, ay, bx, by;
+            toNative(area.x, area.y, ax, ay);
+            toNative(area.x + area.width - 1, area.y + area.height - 1, bx, by);
+
+            const int left = std::max(0, std::min(ax, bx));
+            const int top = std::max(0, std::min(ay, by));
+            const int right = std::min<int>(WIDTH, std::max(ax, bx) + 1);
+            const int bottom = std::min<int>(HEIGHT, std::max(ay, by) + 1);
+            if (left >= right || top >= bottom) return NativeRect{};
+            return NativeRect{left, top, right - left, bottom - top};
+        }
+
+        /** Native rectangle of a logical one, widened to whole bytes and clipped to the panel. */
+        [[nodiscard]] NativeRect alignedNativeRect(const RenderContext &area) const {
+            const NativeRect rect = nativeRect(area);
+            if (rect.width <= 0 || rect.height <= 0) return NativeRect{};
+
+            const int left = rect.x & ~7;
+            const int right = std::min<int>(WIDTH, (rect.x + rect.width + 7) & ~7);
+            return NativeRect{left, rect.y, right - left, rect.height};
+        }
+
+        /**
+         * Logical rectangle [x0, x1) x [y0, y1), already clipped, into the
+         * page buffer only. GxEPD2 keeps its buffer private, so this is one
+         * drawPixel per pixel, but without the virtual writePixel chain of
+         * Adafruit_GFX and without touching the shadow frame.
+         */
+        void fillPanelRect(const int x0, const int y0, const int x1, const int y1, const uint16_t color) {
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    Base::drawPixel(static_cast<int16_t>(x), static_cast<int16_t>(y), color);
+                }
+            }
+        }
+
+        /** Horizontal native run into the page buffer, as the logical rectangle it maps to. */
+        void fillPanelRun(const int nx, const int ny, const int length, const uint16_t color) {
+            int ax, ay, bx, by;
+            toLogical(nx, ny, ax, ay);
+            toLogical(nx + length - 1, ny, bx, by);
+            fillPanelRect(std::min(ax, bx), std::min(ay, by), std::max(ax, bx) + 1, std::max(ay, by) + 1, color);
+        }
+
+        /** Set (white) or clear a native rectangle of the shadow frame, limited to the window. */
+        void fillShadowRect(const NativeRect &rect, const bool white) {
+            const int x0 = std::max(rect.x, window.x);
+            const int y0 = std::max(rect.y, window.y);
+            const int x1 = std::min(rect.x + rect.width, window.x + window.width);
+            const int y1 = std::min(rect.y + rect.height, window.y + window.height);
+            if (x0 >= x1 || y0 >= y1) return;
+
+            const int firstByte = x0 / 8;
+            const int lastByte = (x1 - 1) / 8;
+            const uint8_t firstMask = 0xFF >> (x0 % 8);
+            const uint8_t lastMask = 0xFF << (7 - (x1 - 1) % 8);
+            for (int ny = y0; ny < y1; ny++) {
+                uint8_t *row = shadow.get() + ny * STRIDE;
+                if (firstByte == lastByte) {
+                    writeBits(row[firstByte], firstMask & lastMask, white);
+                    continue;
+                }
+                writeBits(row[firstByte], firstMask, white);
+                if (lastByte > firstByte + 1) {
+                    memset(row + firstByte + 1, white ? 0xFF : 0x00, lastByte - firstByte - 1);
+                }
+                writeBits(row[lastByte], lastMask, white);
+            }
+        }
+
+        static void writeBits(uint8_t &byte, const uint8_t mask, const bool set) {
+            if (set) {
+                byte |= mask;
+            } else {
+                byte &= ~mask;
+            }
+        }
+    };
+}
+#endif //EPDDISPLAY_H
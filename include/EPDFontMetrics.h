@@ -0,0 +1,110 @@
+#ifndef EPDFONTMETRICS_H
+#define EPDFONTMETRICS_H
+
+/**
+ * @file EPDFontMetrics.h
+ * Cached per-font metrics with a fast path for monospaced GFXfonts.
+ *
+ * Adafruit_GFX::getTextBounds walks every glyph of a string. For monospaced
+ * fonts the width of a string is simply length * xAdvance and the height is
+ * the constant ascent + descent of the font, so Controller::measureText
+ * answers in O(1) for them. Fonts are scanned once on first use, or can be
+ * declared monospaced explicitly.
+ *
+ * Text is measured from the render task and the menu widget task, so the
+ * cache is filled without locks: a slot is claimed atomically and its font
+ * published only after its metrics are written.
+ */
+
+#include <Adafruit_GFX.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace EPD {
+    struct FontMetrics {
+        const GFXfont *font = nullptr;
+        uint8_t advance = 0; ///< constant glyph advance, 0 for proportional fonts
+        int8_t ascent = 0;   ///< tallest glyph above the baseline
+        int8_t descent = 0;  ///< deepest glyph below the baseline
+
+        [[nodiscard]] bool isMonospace() const { return advance != 0; }
+        [[nodiscard]] uint16_t lineHeight() const { return ascent + descent; }
+        [[nodiscard]] uint16_t textWidth(const size_t length) const { return length * advance; }
+
+        /**
+         * Metrics for a font, computed on first use and cached; safe to call
+         * from any task. Fonts beyond the cache capacity or without a glyph
+         * table report a proportional font, which keeps callers on the
+         * getTextBounds path.
+         */
+        static const FontMetrics &of(const GFXfont *font) {
+            static const FontMetrics unknown{};
+            if (font == nullptr || font->glyph == nullptr) return unknown;
+
+            const size_t claimed = std::min(cacheSize().load(std::memory_order_acquire), CACHE_CAPACITY);
+            for (size_t i = 0; i < claimed; i++) {
+                if (keys()[i].load(std::memory_order_acquire) == font) return cache()[i];
+            }
+
+            // Two tasks meeting a new font at once may both add it; either entry is correct
+            const size_t index = cacheSize().fetch_add(1, std::memory_order_acq_rel);
+            if (index >= CACHE_CAPACITY) return unknown;
+
+            cache()[index] = scan(font);
+            keys()[index].store(font, std::memory_order_release);
+            return cache()[index];
+        }
+
+        /**
+         * Declare a font monospaced with the given advance, e.g. a custom
+         * converted font. Call it during setup, before text is measured
+         * from other tasks.
+         */
+        static void declareMonospace(const GFXfont *font, const uint8_t advance) {
+            FontMetrics &metrics = const_cast<FontMetrics &>(of(font));
+            if (metrics.font == font) {
+                metrics.advance = advance;
+            }
+        }
+
+    private:
+        static constexpr size_t CACHE_CAPACITY = 12;
+
+        static FontMetrics *cache() {
+            static FontMetrics entries[CACHE_CAPACITY];
+            return entries;
+        }
+
+        /** Font of each cache entry, set once the entry can be read. */
+        static std::atomic<const GFXfont *> *keys() {
+            static std::atomic<const GFXfont *> fonts[CACHE_CAPACITY];
+            return fonts;
+        }
+
+        /** Slots claimed so far; may run past CACHE_CAPACITY once the cache is full. */
+        static std::atomic<size_t> &cacheSize() {
+            static std::atomic<size_t> size{0};
+            return size;
+        }
+
+        static FontMetrics scan(const GFXfont *font) {
+            FontMetrics metrics{font};
+            int advance = -1;
+            for (uint16_t c = font->first; c <= font->last; c++) {
+                const GFXglyph &glyph = font->glyph[c - font->first];
+                metrics.ascent = std::max<int8_t>(metrics.ascent, -glyph.yOffset);
+                metrics.descent = std::max<int8_t>(metrics.descent, glyph.yOffset + glyph.height);
+                if (advance < 0) {
+                    advance = glyph.xAdvance;
+                } else if (advance != glyph.xAdvance) {
+                    advance = 0;
+                }
+            }
+            metrics.advance = static_cast<uint8_t>(std::max(advance, 0));
+            return metrics;
+        }
+    };
+}
+#endif //EPDFONTMETRICS_H
@@ -0,0 +1,193 @@
+#ifndef EPDFRAMECACHE_H
+#define EPDFRAMECACHE_H
+
+/**
+ * @file EPDFrameCache.h
+ * Bounded cache of compressed full-screen frames.
+ *
+ * Frames are native 1bpp screens as kept in the shadow frame of
+ * EPD::Display, compressed with PackBits (UI screens are mostly long runs
+ * of white or black bytes). Each entry is keyed by an owner id, e.g. the
+ * serial of a page on the stack, and a version; a frame is only handed back
+ * for the version it was stored with. Owner ids must not be reused, which
+ * rules out addresses of objects that may be freed. When the byte budget is exceeded the least recently used
+ * entries are evicted.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace EPD {
+    class FrameCache {
+        struct Entry {
+            uint32_t owner = 0;
+            uint32_t version = 0;
+            uint32_t lastUse = 0;
+            std::vector<uint8_t> data{};
+        };
+
+        std::vector<Entry> entries{};
+        size_t budget;
+        size_t used = 0;
+        uint32_t useCounter = 0;
+
+    public:
+        static constexpr size_t DEFAULT_BUDGET = 64 * 1024;
+
+        explicit FrameCache(const size_t budget = DEFAULT_BUDGET) : budget(budget) {
+        }
+
+        /** Total bytes the compressed frames may take; shrinking evicts right away. */
+        void setBudget(const size_t bytes) {
+            budget = bytes;
+            evictTo(budget);
+        }
+
+        [[nodiscard]] size_t getBudget() const {
+            return budget;
+        }
+
+        [[nodiscard]] size_t getUsedBytes() const {
+            return used;
+        }
+
+        /**
+         * Compress and keep a frame for owner, replacing its previous one.
+         * @return false if the compressed frame alone exceeds the budget
+         */
+        bool store(const uint32_t owner, const uint32_t version, const uint8_t *frame, const size_t size) {
+            erase(owner);
+
+            std::vector<uint8_t> data;
+            pack(frame, size, data);
+            if (data.size() > budget) return false;
+            data.shrink_to_fit();
+
+            evictTo(budget - data.size());
+            used += data.size();
+            entries.push_back(Entry{owner, version, ++useCounter, std::move(data)});
+            return true;
+        }
+
+        [[nodiscard]] bool contains(const uint32_t owner, const uint32_t version) const {
+            const Entry *entry = find(owner);
+            return entry != nullptr && entry->version == version;
+        }
+
+        /**
+         * Decompress the frame of owner into frame. The data is checked first,
+         * so frame is left untouched when this fails.
+         * @return false if there is none for this version or it does not match size
+         */
+        bool restore(const uint32_t owner, const uint32_t version, uint8_t *frame, const size_t size) {
+            Entry *entry = find(owner);
+            if (entry == nullptr || entry->version != version) return false;
+            if (unpackedSize(entry->data) != size) return false;
+
+            entry->lastUse = ++useCounter;
+            return unpack(entry->data, frame, size);
+        }
+
+        void erase(const uint32_t owner) {
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->owner == owner) {
+                    used -= it->data.size();
+                    entries.erase(it);
+                    return;
+                }
+            }
+        }
+
+        void clear() {
+            entries.clear();
+            used = 0;
+        }
+
+    private:
+        [[nodiscard]] const Entry *find(const uint32_t owner) const {
+            for (const auto &entry: entries) {
+                if (entry.owner == owner) return &entry;
+            }
+            return nullptr;
+        }
+
+        Entry *find(const uint32_t owner) {
+            return const_cast<Entry *>(static_cast<const FrameCache *>(this)->find(owner));
+        }
+
+        void evictTo(const size_t limit) {
+            while (used > limit && !entries.empty()) {
+                auto oldest = entries.begin();
+                for (auto it = entries.begin(); it != entries.end(); ++it) {
+                    if (it->lastUse < oldest->lastUse) oldest = it;
+                }
+                used -= oldest->data.size();
+                entries.erase(oldest);
+            }
+        }
+
+        /**
+         * PackBits: a header byte h < 128 is followed by h + 1 literal bytes,
+         * h > 128 by one byte repeated 257 - h times.
+         */
+        static void pack(const uint8_t *src, const size_t size, std::vector<uint8_t> &out) {
+            size_t i = 0;
+            while (i < size) {
+                size_t run = 1;
+                while (i + run < size && run < 128 && src[i + run] == src[i]) run++;
+                if (run >= 2) {
+                    out.push_back(static_cast<uint8_t>(257 - run));
+                    out.push_back(src[i]);
+                    i += run;
+                    continue;
+                }
+
+                const size_t start = i;
+                while (i < size && i - start < 128 && !(i + 1 < size && src[i] == src[i + 1])) i++;
+                out.push_back(static_cast<uint8_t>(i - start - 1));
+                out.insert(out.end(), src + start, src + i);
+            }
+        }
+
+        /** Bytes the packed data unpacks to, or 0 if it is cut short. */
+        static size_t unpackedSize(const std::vector<uint8_t> &in) {
+            size_t i = 0;
+            size_t o = 0;
+            while (i < in.size()) {
+                const uint8_t header = in[i++];
+                if (header < 128) {
+                    i += header + 1;
+                    o += header + 1;
+                } else if (header > 128) {
+                    i++;
+                    o += 257 - header;
+                }
+            }
+            return i == in.size() ? o : 0;
+        }
+
+        static bool unpack(const std::vector<uint8_t> &in, uint8_t *dst, const size_t size) {
+            size_t i = 0;
+            size_t o = 0;
+            while (i < in.size()) {
+                const uint8_t header = in[i++];
+                if (header < 128) {
+                    const size_t count = header + 1;
+                    if (i + count > in.size() || o + count > size) return false;
+                    memcpy(dst + o, in.data() + i, count);
+                    i += count;
+                    o += count;
+                } else if (header > 128) {
+                    const size_t count = 257 - header;
+                    if (i >= in.size() || o + count > size) return false;
+                    memset(dst + o, in[i++], count);
+                    o += count;
+                }
+            }
+            return o == size;
+        }
+    };
+}
+#endif //EPDFRAMECACHE_H
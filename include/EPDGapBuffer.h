@@ -0,0 +1,100 @@
+#ifndef EPDGAPBUFFER_H
+#define EPDGAPBUFFER_H
+
+/**
+ * @file EPDGapBuffer.h
+ * Fixed-capacity gap buffer for single-line text editing.
+ *
+ * The text is stored as [0, gapStart) + [gapEnd, capacity) with the cursor
+ * at the gap, so inserting, deleting and moving the cursor by one character
+ * are O(1) and never reallocate. Capacity is fixed at construction, which
+ * doubles as the maximum length of the edited text.
+ */
+
+#include <cstddef>
+#include <memory>
+
+namespace EPD {
+    class GapBuffer {
+        std::unique_ptr<char[]> buffer;
+        size_t capacity;
+        size_t gapStart = 0;
+        size_t gapEnd;
+
+    public:
+        explicit GapBuffer(const size_t capacity)
+            : buffer(new char[capacity > 0 ? capacity : 1]), capacity(capacity), gapEnd(capacity) {
+        }
+
+        /** Replace the content, truncated to the capacity; the cursor ends up after it. */
+        void assign(const char *text) {
+            gapStart = 0;
+            gapEnd = capacity;
+            while (text != nullptr && *text != '\0' && gapStart < gapEnd) {
+                buffer[gapStart++] = *text++;
+            }
+        }
+
+        [[nodiscard]] size_t length() const { return capacity - (gapEnd - gapStart); }
+        [[nodiscard]] size_t getCapacity() const { return capacity; }
+        [[nodiscard]] size_t cursor() const { return gapStart; }
+        [[nodiscard]] bool isFull() const { return gapStart == gapEnd; }
+
+        /** Character before / after the cursor, '\0' at the ends. */
+        [[nodiscard]] char before() const { return gapStart > 0 ? buffer[gapStart - 1] : '\0'; }
+        [[nodiscard]] char after() const { return gapEnd < capacity ? buffer[gapEnd] : '\0'; }
+
+        /** Character at a logical position, skipping the gap. */
+        [[nodiscard]] char at(const size_t index) const {
+            return index < gapStart ? buffer[index] : buffer[index + (gapEnd - gapStart)];
+        }
+
+        bool moveLeft() {
+            if (gapStart == 0) return false;
+            buffer[--gapEnd] = buffer[--gapStart];
+            return true;
+        }
+
+        bool moveRight() {
+            if (gapEnd == capacity) return false;
+            buffer[gapStart++] = buffer[gapEnd++];
+            return true;
+        }
+
+        /** Insert before the cursor. */
+        bool insert(const char c) {
+            if (isFull()) return false;
+            buffer[gapStart++] = c;
+            return true;
+        }
+
+        /** Overwrite the character after the cursor. */
+        bool replaceAfter(const char c) {
+            if (gapEnd == capacity) return false;
+            buffer[gapEnd] = c;
+            return true;
+        }
+
+        /** Backspace. */
+        bool eraseBefore() {
+            if (gapStart == 0) return false;
+            gapStart--;
+            return true;
+        }
+
+        /** Forward delete. */
+        bool eraseAfter() {
+            if (gapEnd == capacity) return false;
+            gapEnd++;
+            return true;
+        }
+
+        /** Visit the characters in order, without materializing the text. */
+        template<typename Visitor>
+        void forEach(Visitor &&visit) const {
+            for (size_t i = 0; i < gapStart; i++) visit(buffer[i]);
+            for (size_t i = gapEnd; i < capacity; i++) visit(buffer[i]);
+        }
+    };
+}
+#endif //EPDGAPBUFFER_H
@@ -6,9 +6,27 @@
  *
  * Provides:
  * - EPD::IconRenderContext: extends RenderContext with a color
+ * - EPD::IconBitmap: one 1bpp rendition of an icon at a fixed size
  * - EPD::Icon: draws a bitmap at a given size and color
+ *
+ * convert_icons.py renders every SVG at each requested size, so an Icon
+ * usually holds several bitmaps. Rendering picks the largest one that fits
+ * the requested box and blits it centered; only when every bitmap is too
+ * large does it fall back to scaling down at render time.
+ *
+ * With --atlas the bitmaps of all icons are packed into one blob instead,
+ * and EPD::IconHandle names an icon's run of entries in the atlas index.
+ *
+ * With --compress a bitmap may be stored PackBits encoded. It is decoded a
+ * byte at a time while blitting, so no decompression buffer is needed, but
+ * it can only be drawn at its own size, never scaled.
+ *
+ * Icons listed with --gray are stored as 2bpp GRAY2 bitmaps instead, for
+ * illustrations that benefit from the panel's gray levels. They are not
+ * scaled either and drop to black and white under a fast partial refresh.
  */
 #include <EPDRenderable.h>
+#include <EPDSpan.h>
 
 namespace EPD {
     struct IconRenderContext final : RenderContext {
@@ -32,17 +50,85 @@ namespace EPD {
         }
     };
 
+    enum class IconEncoding : uint8_t {
+        RAW,      ///< rows padded to whole bytes, MSB first
+        PACKBITS, ///< the RAW bytes PackBits encoded as one stream
+        GRAY2,    ///< 2bpp, 4 pixels per byte, see Controller::drawGrayBitmap()
+    };
+
+    struct IconBitmap {
+        uint16_t width;
+        uint16_t height;
+        const unsigned char *data;
+        IconEncoding encoding = IconEncoding::RAW;
+    };
+
+    /** Reads the bytes of a RAW bitmap in order. */
+    class RawBitmapReader {
+        const unsigned char *next;
+
+    public:
+        explicit RawBitmapReader(const unsigned char *data) : next(data) {
+        }
+
+        uint8_t read() {
+            return pgm_read_byte(next++);
+        }
+    };
+
+    /**
+     * Reads the bytes of a PACKBITS bitmap in order. A header byte h < 128 is
+     * followed by h + 1 literal bytes, h > 128 by one byte repeated 257 - h
+     * times; 128 is never written.
+     */
+    class PackBitsReader {
+        const unsigned char *next;
+        uint8_t literal = 0;
+        uint8_t repeat = 0;
+        uint8_t value = 0;
+
+    public:
+        explicit PackBitsReader(const unsigned char *data) : next(data) {
+        }
+
+        uint8_t read() {
+            if (literal == 0 && repeat == 0) {
+                const uint8_t header = pgm_read_byte(next++);
+                if (header < 128) {
+                    literal = header + 1;
+                } else {
+                    repeat = 257 - header;
+                    value = pgm_read_byte(next++);
+                }
+            }
+            if (literal > 0) {
+                literal--;
+                return pgm_read_byte(next++);
+            }
+            repeat--;
+            return value;
+        }
+    };
+
+    /** Icon in an atlas from convert_icons.py --atlas: its sizes are the index entries [first, first + count). */
+    struct IconHandle {
+        uint16_t first;
+        uint16_t count;
+    };
+
     class Icon final : public Renderable {
-        std::pair<int, int> size = {100, 100};
-        const unsigned char *bitmap = nullptr;
+        /** Used when the icon was built from a single bitmap. */
+        IconBitmap base{100, 100, nullptr};
+        Span<const IconBitmap> sizes{};
 
     protected:
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             const auto &iconCtx = static_cast<const IconRenderContext &>(ctx);
 
             if (iconCtx.width == 0 && iconCtx.height == 0) {
-                iconCtx.width = size.first;
-                iconCtx.height = size.second;
+                const auto [width, height] = getSize();
+                iconCtx.width = width;
+                iconCtx.height = height;
             }
             if (iconCtx.width != 0 & iconCtx.height == 0) {
                 iconCtx.height = iconCtx.width;
@@ -50,30 +136,116 @@ namespace EPD {
                 iconCtx.width = iconCtx.height;
             }
 
+            // A single bitmap keeps being scaled to the requested size, as before there were several
+            const IconBitmap &bitmap = getBitmapFor(iconCtx.width, iconCtx.height);
+            const bool exact = bitmap.width == iconCtx.width && bitmap.height == iconCtx.height;
+            const bool fits = bitmap.width <= iconCtx.width && bitmap.height <= iconCtx.height;
+            const int x = iconCtx.x + (iconCtx.width - bitmap.width) / 2;
+            const int y = iconCtx.y + (iconCtx.height - bitmap.height) / 2;
+            if (bitmap.encoding == IconEncoding::PACKBITS) {
+                blit(epd, x, y, bitmap, PackBitsReader(bitmap.data), iconCtx.color);
+                return;
+            }
+            if (bitmap.encoding == IconEncoding::GRAY2) {
+                epd.drawGrayBitmap(x, y, bitmap.data, bitmap.width, bitmap.height, iconCtx.color);
+                return;
+            }
+            if (exact || (!sizes.empty() && fits)) {
+                blit(epd, x, y, bitmap, RawBitmapReader(bitmap.data), iconCtx.color);
+                return;
+            }
+
             epd.drawScaledBitmap(
                 iconCtx.x,
                 iconCtx.y,
-                getBitmap(),
-                size.first,
-                size.second,
+                bitmap.data,
+                bitmap.width,
+                bitmap.height,
                 iconCtx.width,
                 iconCtx.height,
                 iconCtx.color
             );
         }
 
+    private:
+        /** Draw the set bits row by row, one horizontal line per run of them. */
+        template<typename Reader>
+        static void blit(Controller &epd, const int x, const int y, const IconBitmap &bitmap, Reader reader,
+                         const uint16_t color) {
+            auto &display = epd.getDisplay();
+            const int rowBytes = (bitmap.width + 7) / 8;
+            for (int row = 0; row < bitmap.height; row++) {
+                int runStart = -1;
+                for (int column = 0; column < rowBytes; column++) {
+                    const uint8_t byte = reader.read();
+                    // Whole bytes continue or end a run without looking at the bits
+                    if (byte == 0xFF && runStart >= 0) continue;
+                    if (byte == 0x00 && runStart < 0) continue;
+
+                    for (int bit = 0; bit < 8; bit++) {
+                        const int px = column * 8 + bit;
+                        const bool set = px < bitmap.width && (byte & (0x80 >> bit)) != 0;
+                        if (set && runStart < 0) {
+                            runStart = px;
+                        } else if (!set && runStart >= 0) {
+                            display.drawFastHLine(x + runStart, y + row, px - runStart, color);
+                            runStart = -1;
+                        }
+                    }
+                }
+                if (runStart >= 0) {
+                    display.drawFastHLine(x + runStart, y + row, bitmap.width - runStart, color);
+                }
+            }
+        }
+
     public:
         Icon() = default;
 
-        Icon(const std::pair<int, int> &size, const unsigned char *bitmapData): size(size), bitmap(bitmapData) {
+        Icon(const std::pair<int, int> &size, const unsigned char *bitmapData)
+            : base{static_cast<uint16_t>(size.first), static_cast<uint16_t>(size.second), bitmapData} {
         }
 
+        /** The same icon rendered at several sizes, e.g. `static const IconBitmap SIZES[] = {...};` */
+        explicit Icon(const Span<const IconBitmap> sizes) : base(sizes.empty() ? IconBitmap{} : sizes[0]),
+                                                            sizes(sizes) {
+            for (const IconBitmap &bitmap: sizes) {
+                if (bitmap.width * bitmap.height > base.width * base.height) base = bitmap;
+            }
+        }
+
+        /** Size of the largest bitmap, drawn when no size is requested. */
         [[nodiscard]] std::pair<int, int> getSize() const {
-            return size;
+            return {base.width, base.height};
         }
 
+        /** Bitmap of the largest size. */
         [[nodiscard]] const unsigned char *getBitmap() const {
-            return bitmap;
+            return base.data;
+        }
+
+        [[nodiscard]] size_t getBitmapCount() const {
+            return sizes.empty() ? 1 : sizes.size();
+        }
+
+        /**
+         * The largest bitmap that fits into width x height, or the smallest
+         * one if none does and it has to be scaled down (PACKBITS and GRAY2
+         * bitmaps are drawn at their own size instead).
+         */
+        [[nodiscard]] const IconBitmap &getBitmapFor(const int width, const int height) const {
+            if (sizes.empty()) return base;
+
+            const IconBitmap *fitting = nullptr;
+            const IconBitmap *smallest = &sizes[0];
+            for (const IconBitmap &bitmap: sizes) {
+                if (bitmap.width <= width && bitmap.height <= height &&
+                    (fitting == nullptr || bitmap.width * bitmap.height > fitting->width * fitting->height)) {
+                    fitting = &bitmap;
+                }
+                if (bitmap.width * bitmap.height < smallest->width * smallest->height) smallest = &bitmap;
+            }
+            return fitting != nullptr ? *fitting : *smallest;
         }
     };
 }
@@ -15,8 +15,14 @@
  * and an inversion flag to preserve contrast on monochrome e-paper.
  */
 
+#include <limits>
+
 #include <EPDController.h>
 #include <EPDIcon.h>
+#include "EPDCallback.h"
+#include "EPDGapBuffer.h"
+#include "EPDSpan.h"
+#include "EPDString.h"
 
 #include "EPDRenderable.h"
 
@@ -198,6 +204,11 @@ namespace EPD {
             );
         }
 
+        /** Widgets are placed on the layout grid so their partial windows stay byte aligned. */
+        [[nodiscard]] bool isGridAligned() const override {
+            return true;
+        }
+
         // overridden renderer
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             if (!getIsInteractable()) {
@@ -267,18 +278,58 @@ namespace EPD {
         [[nodiscard]] bool getsColorsInverted() const {
             return isInvertedColors;
         }
+
+        /**
+         * Tap at logical screen coordinates. The default treats a tap inside
+         * the painted area like the select action.
+         * @return true if the tap was consumed
+         */
+        virtual bool onTouch(const int x, const int y) {
+            if (!getPaintBounds().contains(x, y)) return false;
+            onAction();
+            return true;
+        }
+
+        /** Tap outside this element while it is active; dismisses it by default. */
+        virtual void onTouchOutside() {
+            deactivate();
+        }
+
+        /**
+         * Whether the element currently floats above the page, e.g. an open
+         * modal or an expanded list. The screen under an overlay is saved when
+         * it opens and restored when it closes, see EPD::OverlayLayer.
+         */
+        [[nodiscard]] virtual bool isOverlay() const {
+            return false;
+        }
+
+        /**
+         * Called by RenderManager right before it redraws a window of this
+         * element, while the shadow frame still shows the last render. The
+         * redraw clears the window first, so pixels worth keeping have to be
+         * saved here.
+         */
+        virtual void prepareRender(Controller &epd) {
+        }
     };
 
     class InteractableButton : public Interactable {
-        String label = "Button";
-        std::function<void()> action{};
+        Label label = "Button";
+        Callback<void()> action{};
         Icon *icon{nullptr};
 
+        static constexpr int PADDING = 12;
+        static constexpr int BORDER_RADIUS = 8;
+
+        uint16_t textHeight = 0;
+        int iconSize = 0;
+
     public:
         explicit InteractableButton(
             const String &id,
-            const String &label,
-            std::function<void()> action
+            const StringRef label,
+            Callback<void()> action
         ): Interactable(id),
            label(label),
            action(std::move(action)) {
@@ -286,9 +337,9 @@ namespace EPD {
 
         explicit InteractableButton(
             const String &id,
-            const String &label,
+            const StringRef label,
             Icon *icon,
-            std::function<void()> action
+            Callback<void()> action
         ): Interactable(id),
            label(label),
            action(std::move(action)),
@@ -304,29 +355,26 @@ namespace EPD {
             //deactivate();
         }
 
-        void renderContent(Controller &epd, const RenderContext &ctx) override {
-            auto &display = epd.getDisplay();
-            display.setFont(&FreeMonoBold12pt7b);
-
-            int16_t x1 = ctx.x, y1 = ctx.y;
-            uint16_t w = ctx.width, h = ctx.height;
-            if (w == 0 || h == 0) {
-                display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &w, &h);
-            }
-
-            constexpr int PADDING = 12;
-            constexpr int BORDER_RADIUS = 8;
+        Size onMeasure(Controller &epd, const Size &available) override {
+            const Controller::Bounds text = epd.measureText(label, &FreeMonoBold12pt7b);
+            const uint16_t w = text.w;
+            const uint16_t h = text.h;
+            textHeight = h;
 
-            ctx.x = (x1 - PADDING + 7) & ~7;
-            ctx.y = (y1 - PADDING + 7) & ~7;
-            ctx.height = (h + PADDING * 2 + 7) & ~7;
+            const int height = snapToGrid(h + PADDING * 2);
 
-            const int ICON_SIZE = ctx.height - PADDING;
+            iconSize = icon != nullptr ? height - PADDING : 0;
+            int width = w + PADDING * 2;
             if (icon != nullptr) {
-                w += PADDING * 2 + ICON_SIZE;
+                width += PADDING * 2 + iconSize;
             }
 
-            ctx.width = (w + PADDING * 2 + 7) & ~7;
+            return {std::max(width, available.width), std::max(height, available.height)};
+        }
+
+        void renderContent(Controller &epd, const RenderContext &ctx) override {
+            auto &display = epd.getDisplay();
+            display.setFont(&FreeMonoBold12pt7b);
 
             uint16_t CALCULATED_COLOR = getBackgroundColor();
 
@@ -375,7 +423,7 @@ namespace EPD {
 
             display.setTextColor(CALCULATED_COLOR);
 
-            const int16_t baselineY = ctx.y + (ctx.height + h) / 2;
+            const int16_t baselineY = ctx.y + (ctx.height + textHeight) / 2;
 
             if (icon != nullptr) {
                 icon->executeRender(
@@ -383,67 +431,75 @@ namespace EPD {
                     IconRenderContext(
                         ctx.x + PADDING,
                         ctx.y + PADDING / 2,
-                        ICON_SIZE,
+                        iconSize,
                         CALCULATED_COLOR
                     )
                 );
-                display.setCursor(ctx.x + PADDING * 2 + ICON_SIZE, baselineY);
+                display.setCursor(ctx.x + PADDING * 2 + iconSize, baselineY);
             } else {
                 display.setCursor(ctx.x + PADDING, baselineY);
             }
 
-            display.print(label);
+            display.print(label.c_str());
         }
     };
 
+    /**
+     * One segment of an InteractableToggle. The label is a plain C string so
+     * option tables can be static data without heap copies; it must outlive
+     * the toggle (string literals do).
+     */
     template<typename ToggleToggleEnumType = int>
     struct ToggleOption {
-        String label{};
+        const char *label = nullptr;
         Icon *icon = nullptr;
         ToggleToggleEnumType enumValue{};
 
         // Constructor without enum value
-        explicit ToggleOption(const String &label, Icon *icon = nullptr)
+        constexpr explicit ToggleOption(const char *label, Icon *icon = nullptr)
             : label(label), icon(icon) {
         }
 
-        explicit ToggleOption(const String &label)
-            : label(label) {
-        }
-
-        explicit ToggleOption(Icon *icon = nullptr)
+        constexpr explicit ToggleOption(Icon *icon = nullptr)
             : icon(icon) {
         }
 
         // Constructor with enum value
-        ToggleOption(const String &label, Icon *icon, ToggleToggleEnumType value)
+        constexpr ToggleOption(const char *label, Icon *icon, ToggleToggleEnumType value)
             : label(label), icon(icon), enumValue(value) {
         }
 
-        ToggleOption(Icon *icon, ToggleToggleEnumType value)
+        constexpr ToggleOption(Icon *icon, ToggleToggleEnumType value)
             : icon(icon), enumValue(value) {
         }
 
-        ToggleOption(const String &label, ToggleToggleEnumType value)
+        constexpr ToggleOption(const char *label, ToggleToggleEnumType value)
             : label(label), enumValue(value) {
         }
     };
 
     template<typename ToggleEnumType = int>
     class InteractableToggle : public Interactable {
-        String label{};
-        std::vector<ToggleOption<ToggleEnumType> > options{};
+        Label label{};
+        /** Viewed, not copied: the table is owned by the page or lives in flash. */
+        Span<const ToggleOption<ToggleEnumType> > options{};
         size_t *currentIndex;
         static constexpr int PADDING = 12;
         static constexpr int TOGGLE_WIDTH = 60;
         static constexpr int TOGGLE_HEIGHT = 30;
         static constexpr int BORDER_RADIUS = 8;
 
+        uint16_t textHeight = 0;
+
+        [[nodiscard]] int getToggleWidth() const {
+            return std::max(TOGGLE_WIDTH, static_cast<int>(options.size() * (TOGGLE_WIDTH / 2)));
+        }
+
     public:
         InteractableToggle(
             const String &id,
-            const String &label,
-            const std::vector<ToggleOption<ToggleEnumType> > &options,
+            const StringRef label,
+            const Span<const ToggleOption<ToggleEnumType> > options,
             size_t *currentIndex
         ) : Interactable(id),
             label(label),
@@ -482,35 +538,29 @@ namespace EPD {
             activate();
         }
 
+        Size onMeasure(Controller &epd, const Size &available) override {
+            // Height of a standard character keeps the spacing when there is no label
+            const Controller::Bounds text = epd.measureText(label.isEmpty() ? "M" : label.c_str(), &FreeMonoBold12pt7b);
+            const uint16_t w = label.isEmpty() ? 0 : text.w;
+            const uint16_t h = text.h;
+            textHeight = h;
+
+            // Calculate needed width based on number of options
+            return {w + getToggleWidth() + PADDING * 3, h + PADDING * 2};
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             auto &display = epd.getDisplay();
             display.setFont(&FreeMonoBold12pt7b);
 
-            int16_t x1 = ctx.x, y1 = ctx.y;
-            uint16_t w = 0, h = 0;
-
-
-            if (!label.isEmpty()) {
-                display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &w, &h);
-            } else {
-                // Get height of a standard character for spacing when no label
-                display.getTextBounds("M", ctx.x, ctx.y, &x1, &y1, &w, &h);
-                w = 0; // Reset width since we don't have a label
-            }
-
-            // Calculate needed width based on number of options
-            const int actualToggleWidth = std::max(TOGGLE_WIDTH, static_cast<int>(options.size() * (TOGGLE_WIDTH / 2)));
-
-            ctx.x = (x1 + 7) & ~7;
-            ctx.y = (y1 - PADDING + 7) & ~7;
-            ctx.width = (w + actualToggleWidth + PADDING * 3 + 7) & ~7;
-            ctx.height = (h + PADDING * 2 + 7) & ~7;
+            const int actualToggleWidth = getToggleWidth();
+            const uint16_t h = textHeight;
 
             // Draw label
             display.setTextColor(getBackgroundColor());
             const int16_t baselineY = ctx.y + (ctx.height + h) / 2;
             display.setCursor(ctx.x + PADDING, baselineY);
-            display.print(label);
+            display.print(label.c_str());
 
             // Draw toggle
             const int toggleX = ctx.x + ctx.width - actualToggleWidth - PADDING;
@@ -598,17 +648,18 @@ namespace EPD {
                     continue;
                 }
 
-                String displayText;
+                char displayText[12];
 
-                if (!options[i].label.isEmpty()) {
-                    displayText = options[i].label.substring(0, 1);
+                if (options[i].label != nullptr && options[i].label[0] != '\0') {
+                    displayText[0] = options[i].label[0];
+                    displayText[1] = '\0';
                 } else {
-                    displayText = String(i);
+                    snprintf(displayText, sizeof(displayText), "%u", static_cast<unsigned>(i));
                 }
 
-                int16_t textX, textY;
-                uint16_t textW, textH;
-                display.getTextBounds(displayText, 0, 0, &textX, &textY, &textW, &textH);
+                const Controller::Bounds text = epd.measureText(displayText, &FreeMonoBold12pt7b);
+                const uint16_t textW = text.w;
+                const uint16_t textH = text.h;
 
                 display.setTextColor(i == *currentIndex ? getForegroundColor() : getBackgroundColor());
                 display.setCursor(
@@ -623,16 +674,25 @@ namespace EPD {
     };
 
     class InteractableSlider : public Interactable {
-        String label{};
+        Label label{};
         int *value;
         int min;
         int max;
         int step;
 
+        static constexpr int PADDING = 12;
+        static constexpr int SLIDER_WIDTH = 128;
+        static constexpr int SLIDER_HEIGHT = 24;
+        static constexpr int KNOB_WIDTH = 16;
+        static constexpr int VALUE_MARGIN = 8;
+        static constexpr int BORDER_RADIUS = 4;
+
+        uint16_t textHeight = 0;
+
     public:
         InteractableSlider(
             const String &id,
-            const String &label,
+            const StringRef label,
             int *value,
             const int min,
             const int max,
@@ -664,31 +724,24 @@ namespace EPD {
         }
 
 
+        Size onMeasure(Controller &epd, const Size &available) override {
+            const Controller::Bounds text = epd.measureText(label, &FreeMonoBold12pt7b);
+            const uint16_t w = text.w;
+            const uint16_t h = text.h;
+            textHeight = h;
+
+            return {w + SLIDER_WIDTH + PADDING * 3, h + PADDING * 2 + VALUE_MARGIN + 24};
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             auto &display = epd.getDisplay();
             display.setFont(&FreeMonoBold12pt7b);
 
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &w, &h);
-
-            constexpr int PADDING = 12;
-            constexpr int SLIDER_WIDTH = 128;
-            constexpr int SLIDER_HEIGHT = 24;
-            constexpr int KNOB_WIDTH = 16;
-            constexpr int VALUE_MARGIN = 8;
-            constexpr int BORDER_RADIUS = 4;
-
-            ctx.x = (x1 + 7) & ~7;
-            ctx.y = (y1 - PADDING + 7) & ~7;
-            ctx.width = (w + SLIDER_WIDTH + PADDING * 3 + 7) & ~7;
-            ctx.height = (h + PADDING * 2 + VALUE_MARGIN + 24 + 7) & ~7;
-
             // Draw label
             display.setTextColor(getBackgroundColor());
-            const int16_t baselineY = ctx.y + (ctx.height + h) / 2 - VALUE_MARGIN - 12;
+            const int16_t baselineY = ctx.y + (ctx.height + textHeight) / 2 - VALUE_MARGIN - 12;
             display.setCursor(ctx.x + PADDING, baselineY);
-            display.print(label);
+            display.print(label.c_str());
 
             // Draw slider track
             const int sliderX = ctx.x + ctx.width - SLIDER_WIDTH - PADDING;
@@ -736,25 +789,23 @@ namespace EPD {
 
             // Current value
             snprintf(valueStr, sizeof(valueStr), "%d", *value);
-            int16_t currentX1, currentY1;
-            uint16_t currentW, currentH;
-            display.getTextBounds(valueStr, 0, 0, &currentX1, &currentY1, &currentW, &currentH);
+            const uint16_t currentW = epd.measureText(valueStr, &FreeMono12pt7b).w;
             display.setCursor(sliderX + (SLIDER_WIDTH - currentW) / 2, sliderY + SLIDER_HEIGHT + VALUE_MARGIN + 12);
             display.print(valueStr);
 
             // Max value
             snprintf(valueStr, sizeof(valueStr), "%d", max);
-            int16_t maxX1, maxY1;
-            uint16_t maxW, maxH;
-            display.getTextBounds(valueStr, 0, 0, &maxX1, &maxY1, &maxW, &maxH);
+            const uint16_t maxW = epd.measureText(valueStr, &FreeMono12pt7b).w;
             display.setCursor(sliderX + SLIDER_WIDTH - maxW, sliderY + SLIDER_HEIGHT + VALUE_MARGIN + 12);
             display.print(valueStr);
         }
     };
 
     class InteractableDropdown : public Interactable {
-        String label{};
-        std::vector<String> options{};
+        Label label{};
+        /** Option tables are viewed, not copied; exactly one of the two is set. */
+        Span<const String> stringOptions{};
+        Span<const char *const> textOptions{};
         size_t *selectedIndex;
         bool isExpanded = false;
         static constexpr int MAX_VISIBLE_ITEMS = 5;
@@ -768,19 +819,71 @@ namespace EPD {
 
         static constexpr int collapsedHeight = ITEM_HEIGHT + PADDING;
 
+        /** Width of the box, wide enough for the label and every option. */
+        int totalWidth = 0;
+
+        /** Widest option in pixels, measured once per option table. */
+        uint16_t maxOptionWidth = 0;
+        bool optionMetricsValid = false;
+
+        [[nodiscard]] size_t optionCount() const {
+            return stringOptions.empty() ? textOptions.size() : stringOptions.size();
+        }
+
+        [[nodiscard]] const char *optionText(const size_t index) const {
+            return stringOptions.empty() ? textOptions[index] : stringOptions[index].c_str();
+        }
+
+        void optionsChanged() {
+            optionMetricsValid = false;
+            if (*selectedIndex >= optionCount()) {
+                *selectedIndex = 0;
+            }
+            invalidateLayout();
+        }
+
         int expandedHeight() const {
             return collapsedHeight +
-                   std::min(MAX_VISIBLE_ITEMS, static_cast<int>(options.size())) * ITEM_HEIGHT;
+                   std::min(MAX_VISIBLE_ITEMS, static_cast<int>(optionCount())) * ITEM_HEIGHT;
         };
 
+        /** First option shown in the expanded list, keeping the selection centered. */
+        int visibleStart() const {
+            return std::max(0, static_cast<int>(*selectedIndex) - MAX_VISIBLE_ITEMS / 2);
+        }
+
     public:
+        /** Options owned by the page, e.g. a member std::vector<String>. */
         InteractableDropdown(
             const String &id,
-            const String &label,
-            const std::vector<String> &options,
+            const StringRef label,
+            const Span<const String> options,
             size_t *selectedIndex
         )
-            : Interactable(id), label(label), options(options), selectedIndex(selectedIndex) {
+            : Interactable(id), label(label), stringOptions(options), selectedIndex(selectedIndex) {
+        }
+
+        /** Options in a static table, e.g. `static const char *const MODES[] = {...};` */
+        InteractableDropdown(
+            const String &id,
+            const StringRef label,
+            const Span<const char *const> options,
+            size_t *selectedIndex
+        )
+            : Interactable(id), label(label), textOptions(options), selectedIndex(selectedIndex) {
+        }
+
+        /** Swap the option table, e.g. after the page reloaded its choices. */
+        void setOptions(const Span<const String> options) {
+            stringOptions = options;
+            textOptions = Span<const char *const>();
+            optionsChanged();
+        }
+
+        void setOptions(const Span<const char *const> options) {
+            stringOptions = Span<const String>();
+            textOptions = options;
+            optionsChanged();
         }
 
         [[nodiscard]] InteractableType getType() const override {
@@ -796,7 +899,6 @@ namespace EPD {
                 activate();
             }
 
-            lastRenderCTX.height = (isExpanded ? expandedHeight() : collapsedHeight + 7) & ~7;
         }
 
         void onActionUp() override {
@@ -807,33 +909,65 @@ namespace EPD {
         }
 
         void onActionDown() override {
-            if (isExpanded && *selectedIndex < options.size() - 1) {
+            if (isExpanded && *selectedIndex + 1 < optionCount()) {
                 (*selectedIndex)++;
                 activate();
             }
         }
 
-        void renderContent(Controller &epd, const RenderContext &ctx) override {
-            auto &display = epd.getDisplay();
-            display.setFont(&FreeMonoBold12pt7b);
+        bool onTouch(const int x, const int y) override {
+            if (!getPaintBounds().contains(x, y)) return false;
+
+            const int row = (y - lastRenderCTX.y) / ITEM_HEIGHT;
+            if (isExpanded && row > 0) {
+                const int option = visibleStart() + row - 1;
+                if (option < static_cast<int>(optionCount())) {
+                    *selectedIndex = option;
+                }
+            }
+            onAction();
+            return true;
+        }
 
+        void onTouchOutside() override {
+            isExpanded = false;
+            deactivate();
+        }
+
+        [[nodiscard]] bool isOverlay() const override {
+            return isExpanded;
+        }
+
+        Size onMeasure(Controller &epd, const Size &available) override {
             // Calculate dimensions
-            int16_t x1, y1;
-            uint16_t labelW, labelH;
-            display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &labelW, &labelH);
-
-            uint16_t maxOptionWidth = 0;
-            for (const auto &option: options) {
-                uint16_t w, h;
-                display.getTextBounds(option, 0, 0, &x1, &y1, &w, &h);
-                maxOptionWidth = std::max(maxOptionWidth, w);
+            const uint16_t labelW = epd.measureText(label, &FreeMonoBold12pt7b).w;
+
+            if (!optionMetricsValid) {
+                maxOptionWidth = 0;
+                for (size_t i = 0; i < optionCount(); i++) {
+                    maxOptionWidth = std::max(maxOptionWidth, epd.measureText(optionText(i), &FreeMonoBold12pt7b).w);
+                }
+                optionMetricsValid = true;
             }
 
-            const int totalWidth = std::max(labelW, maxOptionWidth) + PADDING * 5;
+            totalWidth = std::max(labelW, maxOptionWidth) + PADDING * 5;
+
+            // The option list overflows downwards instead of pushing siblings away
+            return {totalWidth + PADDING, collapsedHeight};
+        }
 
-            // Set the context dimensions
-            ctx.width = (totalWidth + PADDING + 7) & ~7;
-            ctx.height = (isExpanded ? expandedHeight() : collapsedHeight + 7) & ~7;
+        [[nodiscard]] RenderContext getPaintBounds() const override {
+            return RenderContext(
+                lastRenderCTX.x,
+                lastRenderCTX.y,
+                lastRenderCTX.width,
+                snapToGrid(isExpanded ? expandedHeight() : collapsedHeight)
+            );
+        }
+
+        void renderContent(Controller &epd, const RenderContext &ctx) override {
+            auto &display = epd.getDisplay();
+            display.setFont(&FreeMonoBold12pt7b);
 
             // Draw main container
             const int baseX = ctx.x + PADDING;
@@ -860,13 +994,13 @@ namespace EPD {
             // Draw label
             /*display.setTextColor(getBackgroundColor());
             display.setCursor(baseX + PADDING, baseY + ITEM_HEIGHT - PADDING / 2);
-            display.print(label);*/
+            display.print(label.c_str());*/
 
             // Draw selected value and arrow
             display.setTextColor(getBackgroundColor());
             const int valueY = baseY + ITEM_HEIGHT - PADDING - (PADDING / 2);
             display.setCursor(baseX + PADDING, valueY);
-            display.print(options[*selectedIndex]);
+            display.print(optionText(*selectedIndex));
 
             // Draw arrow
             const int arrowX = baseX + totalWidth - PADDING - ARROW_SIZE;
@@ -897,8 +1031,8 @@ namespace EPD {
 
             // Draw options when expanded
             if (isExpanded) {
-                const int start = std::max(0, static_cast<int>(*selectedIndex) - MAX_VISIBLE_ITEMS / 2);
-                const int end = std::min(static_cast<int>(options.size()), start + MAX_VISIBLE_ITEMS);
+                const int start = visibleStart();
+                const int end = std::min(static_cast<int>(optionCount()), start + MAX_VISIBLE_ITEMS);
 
                 for (int i = start; i < end; i++) {
                     const int itemY = baseY + ITEM_HEIGHT * (i - start + 1);
@@ -916,7 +1050,7 @@ namespace EPD {
                         display.setTextColor(getBackgroundColor());
                     }
                     display.setCursor(baseX + PADDING, itemY + ITEM_HEIGHT - PADDING - (PADDING / 2));
-                    display.print(options[i]);
+                    display.print(optionText(i));
                 }
             }
 
@@ -936,25 +1070,161 @@ namespace EPD {
         }
     };
 
+    /**
+     * Single-line text field edited with the directional keys.
+     *
+     * Left/right move the cursor, select starts editing the character after
+     * the cursor (or appends at the end), left/right then cycle through
+     * VALID_CHARS and select confirms. Down deletes the character after the
+     * cursor, or the last one when the cursor is at the end.
+     *
+     * The text lives in a gap buffer sized to maxLength and the pixel offset
+     * of the cursor is kept up to date per edit, so no prefix of the text is
+     * re-measured. Each edit marks only the glyph cells it touched dirty. The
+     * bound String receives the plain text, without padding.
+     */
     class InteractableTextInput : public Interactable {
-        String label{};
+        Label label{};
         String *value{};
-        static constexpr int MAX_LENGTH = 32;
+        static constexpr size_t DEFAULT_MAX_LENGTH = 64;
         static constexpr int PADDING = 12;
         static constexpr int INPUT_HEIGHT = 40;
         static constexpr int BORDER_RADIUS = 8;
-        size_t cursorPos = 0;
         static constexpr char VALID_CHARS[] =
                 " ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789.,!?-_@#$%&";
+        static constexpr size_t VALID_CHAR_COUNT = sizeof(VALID_CHARS) - 1;
+        /** Width of the edit highlight and fallback advance, matches FreeMonoBold12pt7b. */
+        static constexpr int CELL_WIDTH = 14;
+        /** Inset of refresh windows from the box edge, clear of the selection border. */
+        static constexpr int DIRTY_INSET = 4;
         size_t currentCharIndex = 0;
         bool isEditing = false;
 
+        static constexpr int INPUT_WIDTH = 200;
+        static constexpr int TEXT_WIDTH = INPUT_WIDTH - PADDING * 2;
+        uint16_t labelHeight = 0;
+
+        GapBuffer text;
+        int cursorX = 0;    ///< pixel offset of the cursor from the start of the text
+        int textWidth = 0;  ///< pixel width of the whole text
+        int scrollX = 0;    ///< horizontal scroll of the text inside the box
+
+        /** Dirty span in text pixels, empty when dirtyLeft >= dirtyRight. */
+        int dirtyLeft = 0;
+        int dirtyRight = 0;
+
+        static int glyphAdvance(const char c) {
+            const GFXfont *font = &FreeMonoBold12pt7b;
+            const auto code = static_cast<uint8_t>(c);
+            if (font->glyph == nullptr || code < font->first || code > font->last) {
+                return CELL_WIDTH;
+            }
+            return font->glyph[code - font->first].xAdvance;
+        }
+
+        void markDirty(const int left, const int right) {
+            if (dirtyLeft >= dirtyRight) {
+                dirtyLeft = left;
+                dirtyRight = right;
+            } else {
+                dirtyLeft = std::min(dirtyLeft, left);
+                dirtyRight = std::max(dirtyRight, right);
+            }
+        }
+
+        /** Cursor line and edit highlight at the current cursor position. */
+        void markCursorDirty() {
+            markDirty(cursorX - 1, cursorX + CELL_WIDTH);
+        }
+
+        void markAllDirty() {
+            markDirty(scrollX - 1, scrollX + TEXT_WIDTH + 1);
+        }
+
+        /** Scroll so the cursor cell stays inside the box; scrolling redraws the whole field. */
+        void ensureCursorVisible() {
+            int scroll = scrollX;
+            if (cursorX < scroll) {
+                scroll = cursorX;
+            } else if (cursorX + CELL_WIDTH > scroll + TEXT_WIDTH) {
+                scroll = cursorX + CELL_WIDTH - TEXT_WIDTH;
+            }
+            if (scroll != scrollX) {
+                scrollX = scroll;
+                markAllDirty();
+            }
+        }
+
+        void moveCursor(const bool left) {
+            markCursorDirty();
+            if (left) {
+                if (!text.moveLeft()) return;
+                cursorX -= glyphAdvance(text.after());
+            } else {
+                if (!text.moveRight()) return;
+                cursorX += glyphAdvance(text.before());
+            }
+            markCursorDirty();
+            ensureCursorVisible();
+        }
+
+        /** Write the edited text back to the bound String; its capacity is reserved once. */
+        void syncValue() {
+            value->remove(0, value->length());
+            text.forEach([this](const char c) { value->concat(c); });
+        }
+
+        void commitCharacter(const char c) {
+            if (text.after() != '\0') {
+                const int oldAdvance = glyphAdvance(text.after());
+                const int newAdvance = glyphAdvance(c);
+                text.replaceAfter(c);
+                textWidth += newAdvance - oldAdvance;
+                // A proportional glyph of another width shifts everything after it
+                markDirty(cursorX - 1, oldAdvance == newAdvance ? cursorX + CELL_WIDTH : textWidth + CELL_WIDTH);
+            } else if (text.insert(c)) {
+                markCursorDirty();
+                cursorX += glyphAdvance(c);
+                textWidth += glyphAdvance(c);
+                markCursorDirty();
+                ensureCursorVisible();
+            }
+            syncValue();
+        }
+
+        void deleteCharacter() {
+            const int oldWidth = textWidth;
+            if (text.after() != '\0') {
+                textWidth -= glyphAdvance(text.after());
+                text.eraseAfter();
+            } else if (text.before() != '\0') {
+                const int advance = glyphAdvance(text.before());
+                text.eraseBefore();
+                cursorX -= advance;
+                textWidth -= advance;
+            } else {
+                return;
+            }
+            markDirty(cursorX - 1, oldWidth + CELL_WIDTH);
+            ensureCursorVisible();
+            syncValue();
+        }
+
     public:
-        InteractableTextInput(const String &id, const String &label, String *value)
-            : Interactable(id), label(label), value(value) {
-            cursorPos = value->length();
-            while (value->length() < MAX_LENGTH) {
-                value->concat(' ');
+        InteractableTextInput(
+            const String &id,
+            const StringRef label,
+            String *value,
+            const size_t maxLength = DEFAULT_MAX_LENGTH
+        ) : Interactable(id), label(label), value(value), text(maxLength) {
+            text.assign(value->c_str());
+            text.forEach([this](const char c) { textWidth += glyphAdvance(c); });
+            cursorX = textWidth;
+            ensureCursorVisible();
+
+            value->reserve(maxLength);
+            if (value->length() > maxLength) {
+                syncValue();
             }
         }
 
@@ -962,21 +1232,26 @@ namespace EPD {
             return InteractableType::TEXT;
         }
 
+        [[nodiscard]] size_t getMaxLength() const {
+            return text.getCapacity();
+        }
+
         void onAction() override {
+            markCursorDirty();
             if (isEditing) {
                 // Confirm character selection and exit editing mode
-                value->setCharAt(cursorPos, VALID_CHARS[currentCharIndex]);
+                commitCharacter(VALID_CHARS[currentCharIndex]);
                 isEditing = false;
                 deactivate();
             } else if (getIsActive()) {
                 // Exit active mode entirely
                 deactivate();
-            } else {
-                // Start editing current character
+            } else if (text.after() != '\0' || !text.isFull()) {
+                // Start editing the character after the cursor, or a new one at the end
                 isEditing = true;
                 currentCharIndex = 0;
-                for (size_t i = 0; i < strlen(VALID_CHARS); i++) {
-                    if (VALID_CHARS[i] == value->charAt(cursorPos)) {
+                for (size_t i = 0; i < VALID_CHAR_COUNT; i++) {
+                    if (VALID_CHARS[i] == text.after()) {
                         currentCharIndex = i;
                         break;
                     }
@@ -988,16 +1263,10 @@ namespace EPD {
         void onActionLeft() override {
             if (isEditing) {
                 // Cycle through characters
-                if (currentCharIndex > 0) {
-                    currentCharIndex--;
-                } else {
-                    currentCharIndex = strlen(VALID_CHARS) - 1;
-                }
+                currentCharIndex = currentCharIndex > 0 ? currentCharIndex - 1 : VALID_CHAR_COUNT - 1;
+                markCursorDirty();
             } else {
-                // Move cursor left
-                if (cursorPos > 0) {
-                    cursorPos--;
-                }
+                moveCursor(true);
             }
             activate();
         }
@@ -1005,46 +1274,62 @@ namespace EPD {
         void onActionRight() override {
             if (isEditing) {
                 // Cycle through characters
-                if (currentCharIndex < strlen(VALID_CHARS) - 1) {
-                    currentCharIndex++;
-                } else {
-                    currentCharIndex = 0;
-                }
+                currentCharIndex = currentCharIndex + 1 < VALID_CHAR_COUNT ? currentCharIndex + 1 : 0;
+                markCursorDirty();
             } else {
-                // Move cursor right
-                if (cursorPos < value->length() - 1) {
-                    cursorPos++;
-                }
+                moveCursor(false);
             }
             activate();
         }
 
         void onActionDown() override {
             if (!isEditing) {
-                // Replace current character with space
-                value->setCharAt(cursorPos, ' ');
+                deleteCharacter();
                 activate();
             }
         }
 
+        void onTouchOutside() override {
+            isEditing = false;
+            markCursorDirty();
+            deactivate();
+        }
+
+        Size onMeasure(Controller &epd, const Size &available) override {
+            const uint16_t labelH = epd.measureText(label, &FreeMonoBold12pt7b).h;
+            labelHeight = labelH;
+
+            return {INPUT_WIDTH + PADDING * 2, labelH + INPUT_HEIGHT + PADDING * 3};
+        }
+
+        /** Only the glyph cells touched since the last render, clipped to the text area. */
+        [[nodiscard]] RenderContext getDirtyBounds() const override {
+            if (dirtyLeft >= dirtyRight) return RenderContext();
+
+            const int textX = lastRenderCTX.x + PADDING * 2;
+            const int left = std::max(dirtyLeft - scrollX, -1);
+            const int right = std::min(dirtyRight - scrollX, TEXT_WIDTH + 1);
+            if (left >= right) return RenderContext();
+
+            // Full inner height of the box so ascenders and descenders are covered
+            return RenderContext(
+                textX + left,
+                lastRenderCTX.y + labelHeight + PADDING + DIRTY_INSET,
+                right - left,
+                INPUT_HEIGHT - DIRTY_INSET * 2
+            );
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             auto &display = epd.getDisplay();
             display.setFont(&FreeMonoBold12pt7b);
 
-            int16_t x1, y1;
-            uint16_t labelW, labelH;
-            display.getTextBounds(label, ctx.x, ctx.y, &x1, &y1, &labelW, &labelH);
-
-            constexpr int INPUT_WIDTH = 200;
-            ctx.x = (x1 + 7) & ~7;
-            ctx.y = (y1 + 7) & ~7;
-            ctx.width = (INPUT_WIDTH + PADDING * 2 + 7) & ~7;
-            ctx.height = (labelH + INPUT_HEIGHT + PADDING * 3 + 7) & ~7;
+            const uint16_t labelH = labelHeight;
 
             // Draw label
             display.setTextColor(getBackgroundColor());
             display.setCursor(ctx.x + PADDING, ctx.y + labelH);
-            display.print(label);
+            display.print(label.c_str());
 
             // Draw input box
             const int inputX = ctx.x + PADDING;
@@ -1066,43 +1351,416 @@ namespace EPD {
                 display.drawRoundRect(inputX, inputY, INPUT_WIDTH, INPUT_HEIGHT, BORDER_RADIUS, getBackgroundColor());
             }
 
-            // Draw text
+            // Draw the visible part of the text
+            const int textX = inputX + PADDING;
+            const int baselineY = inputY + INPUT_HEIGHT - PADDING;
             display.setTextColor(getBackgroundColor());
-            display.setCursor(inputX + PADDING, inputY + INPUT_HEIGHT - PADDING);
-            display.print(*value);
+            int x = 0;
+            text.forEach([&](const char c) {
+                const int advance = glyphAdvance(c);
+                if (x >= scrollX && x + advance <= scrollX + TEXT_WIDTH) {
+                    display.setCursor(textX + x - scrollX, baselineY);
+                    display.print(c);
+                }
+                x += advance;
+            });
 
             // Draw cursor or editing highlight
-            const int cursorX = inputX + PADDING + getCursorXOffset(epd);
+            const int screenCursorX = textX + cursorX - scrollX;
             if (isEditing) {
                 // Highlight current character being edited
-                display.fillRect(cursorX - 1, inputY + PADDING, 14, INPUT_HEIGHT - PADDING * 2, getBackgroundColor());
+                display.fillRect(screenCursorX - 1, inputY + PADDING, CELL_WIDTH, INPUT_HEIGHT - PADDING * 2, getBackgroundColor());
                 display.setTextColor(getForegroundColor());
-                display.setCursor(cursorX, inputY + INPUT_HEIGHT - PADDING);
+                display.setCursor(screenCursorX, baselineY);
                 display.print(VALID_CHARS[currentCharIndex]);
             } else {
                 // Show cursor position
-                display.drawFastVLine(cursorX, inputY + PADDING, INPUT_HEIGHT - PADDING * 2, getBackgroundColor());
+                display.drawFastVLine(screenCursorX, inputY + PADDING, INPUT_HEIGHT - PADDING * 2, getBackgroundColor());
             }
+
+            dirtyLeft = dirtyRight = 0;
         }
+    };
+
+    /** Row content pulled from an InteractableList data source. */
+    struct ListRow {
+        Label text{};
+        Icon *icon{nullptr};
+    };
+
+    /**
+     * Virtualized list for large or generated data sets (logs, inventories).
+     *
+     * Rows are pulled on demand from a provider callback and only the visible
+     * rows plus a small prefetch window stay resident in a fixed ring cache
+     * of fixed-capacity rows, so the list allocates nothing while scrolling.
+     * Select activates the list, up/down move the highlight, select again
+     * reports the highlighted row and releases the list.
+     *
+     * Scrolling jumps by a page when the highlight leaves the window. Moving
+     * the highlight inside the window only marks the two affected rows dirty,
+     * which getDirtyBounds() reports so the refresh window covers just them.
+     * Rows still visible after a scroll (a page clamped at either end of the
+     * list) are moved in the display's shadow frame, if it has one, so only
+     * the rows that scrolled in are drawn again.
+     */
+    class InteractableList : public Interactable {
+    public:
+        using RowProvider = Callback<void(size_t index, ListRow &row)>;
+        using SelectCallback = Callback<void(size_t index)>;
 
     private:
-        int getCursorXOffset(Controller &epd) const {
-            if (cursorPos == 0) return 0;
+        struct CachedRow {
+            size_t index = NO_ROW;
+            ListRow row{};
+        };
+
+        static constexpr size_t NO_ROW = static_cast<size_t>(-1);
+        static constexpr int PADDING = 8;
+        static constexpr int BORDER_RADIUS = 8;
+        static constexpr int ROW_HEIGHT = 40;
+        static constexpr int ICON_SIZE = ROW_HEIGHT - PADDING * 2;
+        static constexpr int SCROLLBAR_WIDTH = 4;
+        static constexpr int CHAR_WIDTH = 14; ///< advance of FreeMonoBold12pt7b
+        static constexpr int PREFETCH_ROWS = 2;
+        static constexpr int DEFAULT_WIDTH = 240;
+
+        RowProvider provider{};
+        SelectCallback selectCallback{};
+        size_t itemCount;
+        int visibleRows;
+        int width;
+
+        size_t selected = 0;
+        size_t firstVisible = 0;
+
+        /** Direct-mapped by index; holds the visible window plus prefetch on both sides. */
+        std::vector<CachedRow> cache{};
+
+        /** Dirty range in window rows, empty when dirtyFirst > dirtyLast. */
+        int dirtyFirst = std::numeric_limits<int>::max();
+        int dirtyLast = -1;
+
+        /** What the last render showed, to move rows that stay visible after a scroll. */
+        size_t drawnFirst = NO_ROW;
+        size_t drawnSelected = NO_ROW;
+        RenderContext drawnRect = RenderContext();
+
+        /** Rows saved by prepareRender at their new place, put back by the next renderContent. */
+        Display::FrameRegion scrolledRows{};
+        int keptFirst = 0;
+        int keptRows = 0;
+
+        const ListRow &rowAt(const size_t index) {
+            CachedRow &slot = cache[index % cache.size()];
+            if (slot.index != index) {
+                slot.row = ListRow();
+                if (provider) {
+                    provider(index, slot.row);
+                }
+                slot.index = index;
+            }
+            return slot.row;
+        }
+
+        void prefetch() {
+            const size_t from = firstVisible > PREFETCH_ROWS ? firstVisible - PREFETCH_ROWS : 0;
+            const size_t to = std::min(itemCount, firstVisible + visibleRows + PREFETCH_ROWS);
+            for (size_t i = from; i < to; i++) {
+                rowAt(i);
+            }
+        }
+
+        void markAllDirty() {
+            dirtyFirst = 0;
+            dirtyLast = visibleRows - 1;
+        }
+
+        void clearDirty() {
+            dirtyFirst = std::numeric_limits<int>::max();
+            dirtyLast = -1;
+        }
+
+        [[nodiscard]] bool isDrawnAt(const RenderContext &ctx) const {
+            return ctx.x == drawnRect.x && ctx.y == drawnRect.y &&
+                   ctx.width == drawnRect.width && ctx.height == drawnRect.height;
+        }
+
+        /**
+         * Save the rows that were drawn before and are still visible after a
+         * scroll from the shadow frame, moved to their new place.
+         */
+        void captureKeptRows(Controller &epd) {
+            keptRows = 0;
+            auto &display = epd.getDisplay();
+            if (drawnFirst == NO_ROW || drawnFirst == firstVisible || !display.hasShadowFrame() ||
+                !isDrawnAt(lastRenderCTX)) {
+                return;
+            }
+
+            const size_t keptStart = std::max(drawnFirst, firstVisible);
+            const size_t keptEnd = std::min(std::min(drawnFirst, firstVisible) + visibleRows, itemCount);
+            if (keptEnd <= keptStart) return;
+
+            // Only text and icons of rows that are not highlighted are kept, so stay clear of the
+            // border, the scrollbar and the highlight's rounded corners
+            const int kept = static_cast<int>(keptEnd - keptStart);
+            const int from = static_cast<int>(keptStart - drawnFirst);
+            const int to = static_cast<int>(keptStart - firstVisible);
+            const RenderContext area(
+                drawnRect.x + BORDER_RADIUS,
+                drawnRect.y + from * ROW_HEIGHT,
+                drawnRect.width - BORDER_RADIUS - LAYOUT_GRID * 2,
+                kept * ROW_HEIGHT
+            );
+            if (!display.captureRegion(area, scrolledRows)) return;
+
+            display.moveRegion(scrolledRows, 0, (to - from) * ROW_HEIGHT);
+            keptFirst = to;
+            keptRows = kept;
+        }
+
+        /** Draw the rows saved by captureKeptRows; drops them if the list changed since. */
+        void restoreKeptRows(Controller &epd, const RenderContext &ctx) {
+            if (keptRows > 0 && drawnFirst != firstVisible && isDrawnAt(ctx)) {
+                epd.getDisplay().restoreRegion(scrolledRows);
+            } else {
+                keptRows = 0;
+            }
+        }
+
+        void markRowDirty(const size_t index) {
+            if (index < firstVisible || index >= firstVisible + visibleRows) return;
+            const int row = static_cast<int>(index - firstVisible);
+            dirtyFirst = std::min(dirtyFirst, row);
+            dirtyLast = std::max(dirtyLast, row);
+        }
+
+        void moveSelection(const int delta) {
+            if (itemCount == 0) return;
+            if ((delta < 0 && selected == 0) || (delta > 0 && selected + 1 >= itemCount)) return;
+
+            const size_t previous = selected;
+            selected += delta;
+
+            if (selected < firstVisible) {
+                // Page up: keep the new highlight at the bottom of the window
+                firstVisible = selected + 1 >= static_cast<size_t>(visibleRows) ? selected + 1 - visibleRows : 0;
+                markAllDirty();
+            } else if (selected >= firstVisible + visibleRows) {
+                // Page down: the new highlight becomes the first row
+                firstVisible = std::min(selected, itemCount > static_cast<size_t>(visibleRows) ? itemCount - visibleRows : 0);
+                markAllDirty();
+            } else {
+                markRowDirty(previous);
+                markRowDirty(selected);
+            }
+            activate();
+        }
+
+        void drawRow(Controller &epd, const RenderContext &ctx, const int row, const ListRow &data, const bool highlighted) {
             auto &display = epd.getDisplay();
+            const int rowX = ctx.x + PADDING / 2;
+            const int rowY = ctx.y + row * ROW_HEIGHT;
+            const int rowWidth = ctx.width - PADDING - SCROLLBAR_WIDTH * 2;
 
-            String textUpToCursor = value->substring(0, cursorPos);
-            int16_t x1, y1;
-            uint16_t w, h;
-            display.getTextBounds(textUpToCursor, 0, 0, &x1, &y1, &w, &h);
-            return w;
+            if (highlighted) {
+                display.fillRoundRect(rowX, rowY, rowWidth, ROW_HEIGHT, BORDER_RADIUS, getBackgroundColor());
+            }
+            const uint16_t color = highlighted ? getForegroundColor() : getBackgroundColor();
+
+            int textX = rowX + PADDING;
+            if (data.icon != nullptr) {
+                data.icon->executeRender(epd, IconRenderContext(textX, rowY + PADDING, ICON_SIZE, color));
+                textX += ICON_SIZE + PADDING;
+            }
+
+            // Monospace font: truncate by character count instead of measuring each row
+            const size_t maxChars = std::max(0, rowX + rowWidth - PADDING - textX) / CHAR_WIDTH;
+            const size_t length = std::min(data.text.length(), maxChars);
+
+            display.setTextColor(color);
+            display.setCursor(textX, rowY + ROW_HEIGHT - PADDING - PADDING / 2);
+            const char *text = data.text.c_str();
+            for (size_t i = 0; i < length; i++) {
+                display.print(text[i]);
+            }
+        }
+
+        void drawScrollbar(Controller &epd, const RenderContext &ctx) const {
+            if (itemCount <= static_cast<size_t>(visibleRows)) return;
+
+            const int trackX = ctx.x + ctx.width - SCROLLBAR_WIDTH * 2;
+            const int trackHeight = ctx.height - PADDING * 2;
+            const int thumbHeight = std::max(PADDING, static_cast<int>(trackHeight * visibleRows / itemCount));
+            const int thumbY = ctx.y + PADDING +
+                               static_cast<int>((trackHeight - thumbHeight) * firstVisible /
+                                                (itemCount - visibleRows));
+
+            epd.getDisplay().fillRect(trackX, thumbY, SCROLLBAR_WIDTH, thumbHeight, getBackgroundColor());
+        }
+
+    public:
+        InteractableList(
+            const String &id,
+            const size_t itemCount,
+            RowProvider provider,
+            const int visibleRows = 5,
+            SelectCallback onSelect = nullptr,
+            const int width = DEFAULT_WIDTH
+        ) : Interactable(id),
+            provider(std::move(provider)),
+            selectCallback(std::move(onSelect)),
+            itemCount(itemCount),
+            visibleRows(std::max(1, visibleRows)),
+            width(width),
+            cache(this->visibleRows + PREFETCH_ROWS * 2) {
+        }
+
+        [[nodiscard]] InteractableType getType() const override {
+            return InteractableType::SELECT;
+        }
+
+        void onAction() override {
+            if (getIsActive()) {
+                if (selectCallback && selected < itemCount) {
+                    selectCallback(selected);
+                }
+                deactivate();
+            } else {
+                activate();
+            }
+            markAllDirty();
+        }
+
+        void onActionUp() override {
+            moveSelection(-1);
+        }
+
+        void onActionDown() override {
+            moveSelection(1);
+        }
+
+        bool onTouch(const int x, const int y) override {
+            if (!getPaintBounds().contains(x, y)) return false;
+
+            const size_t index = firstVisible + (y - lastRenderCTX.y) / ROW_HEIGHT;
+            if (index >= itemCount) return true;
+
+            if (getIsActive() && index == selected) {
+                onAction();
+            } else {
+                markRowDirty(selected);
+                selected = index;
+                markRowDirty(selected);
+                activate();
+            }
+            return true;
+        }
+
+        /**
+         * Change the number of rows and drop cached rows, e.g. after new log
+         * entries arrived. Keeps the highlight in range.
+         */
+        void setItemCount(const size_t count) {
+            itemCount = count;
+            selected = count == 0 ? 0 : std::min(selected, count - 1);
+            firstVisible = std::min(firstVisible, selected);
+            invalidateRows();
+        }
+
+        /** Drop cached rows so they are pulled again from the provider. */
+        void invalidateRows() {
+            for (auto &slot: cache) {
+                slot.index = NO_ROW;
+                slot.row = ListRow();
+            }
+            drawnFirst = NO_ROW;
+            markAllDirty();
+        }
+
+        [[nodiscard]] size_t getSelectedIndex() const {
+            return selected;
+        }
+
+        [[nodiscard]] size_t getItemCount() const {
+            return itemCount;
+        }
+
+        Size onMeasure(Controller &epd, const Size &available) override {
+            return {width > 0 ? width : available.width, visibleRows * ROW_HEIGHT};
+        }
+
+        void prepareRender(Controller &epd) override {
+            captureKeptRows(epd);
+        }
+
+        [[nodiscard]] RenderContext getDirtyBounds() const override {
+            if (dirtyFirst > dirtyLast) return RenderContext();
+            if (dirtyFirst == 0 && dirtyLast == visibleRows - 1) return getPaintBounds();
+
+            return RenderContext(
+                lastRenderCTX.x,
+                lastRenderCTX.y + dirtyFirst * ROW_HEIGHT,
+                lastRenderCTX.width,
+                (dirtyLast - dirtyFirst + 1) * ROW_HEIGHT
+            );
+        }
+
+        void renderContent(Controller &epd, const RenderContext &ctx) override {
+            auto &display = epd.getDisplay();
+            display.setFont(&FreeMonoBold12pt7b);
+
+            display.fillRoundRect(ctx.x, ctx.y, ctx.width, ctx.height, BORDER_RADIUS, getForegroundColor());
+
+            restoreKeptRows(epd, ctx);
+
+            for (int row = 0; row < visibleRows; row++) {
+                const size_t index = firstVisible + row;
+                if (index >= itemCount) break;
+
+                const bool kept = row >= keptFirst && row < keptFirst + keptRows;
+                if (kept && index != selected && index != drawnSelected) continue;
+                if (kept) {
+                    // Clear the moved pixels of a row whose highlight changed
+                    display.fillRect(ctx.x + BORDER_RADIUS, ctx.y + row * ROW_HEIGHT,
+                                     ctx.width - BORDER_RADIUS * 2, ROW_HEIGHT, getForegroundColor());
+                }
+                drawRow(epd, ctx, row, rowAt(index), index == selected && (getIsActive() || getIsSelected()));
+            }
+
+            drawScrollbar(epd, ctx);
+
+            if (getIsActive()) {
+                epd.drawMultiRoundRectBorder(
+                    ctx.x,
+                    ctx.y,
+                    ctx.width,
+                    ctx.height,
+                    getBackgroundColor(),
+                    2,
+                    1,
+                    2,
+                    BORDER_RADIUS
+                );
+            } else {
+                display.drawRoundRect(ctx.x, ctx.y, ctx.width, ctx.height, BORDER_RADIUS, getBackgroundColor());
+            }
+
+            prefetch();
+            clearDirty();
+            keptRows = 0;
+            drawnFirst = firstVisible;
+            drawnSelected = selected;
+            drawnRect = RenderContext(ctx.x, ctx.y, ctx.width, ctx.height);
         }
     };
 
     class InteractableModal : public Interactable {
         int width;
         int height;
-        std::function<void(Controller &epd, const RenderContext &ctx)> contentRenderer{};
-        std::function<void()> closeCallback{};
+        Callback<void(Controller &epd, const RenderContext &ctx)> contentRenderer{};
+        Callback<void()> closeCallback{};
         static constexpr int BORDER_RADIUS = 8;
         static constexpr int PADDING = 12;
         bool dismissOnAction = true;
@@ -1112,9 +1770,9 @@ namespace EPD {
             const String &id,
             const int width,
             const int height,
-            std::function<void(Controller &epd, const RenderContext &ctx)> contentRenderer,
+            Callback<void(Controller &epd, const RenderContext &ctx)> contentRenderer,
             const bool dismissOnAction = true,
-            std::function<void()> closeCallback = nullptr
+            Callback<void()> closeCallback = nullptr
         ) : Interactable(id),
             width(width),
             height(height),
@@ -1142,6 +1800,34 @@ namespace EPD {
             }
         }
 
+        /** Modal: taps outside are swallowed until the modal is dismissed. */
+        void onTouchOutside() override {
+        }
+
+        [[nodiscard]] bool isOverlay() const override {
+            return getIsActive();
+        }
+
+        /** Nothing is painted while the modal is hidden, so it cannot be hit either. */
+        [[nodiscard]] RenderContext getPaintBounds() const override {
+            if (!getIsSelected() && !getIsActive()) return RenderContext();
+            return Interactable::getPaintBounds();
+        }
+
+        Size onMeasure(Controller &epd, const Size &available) override {
+            return {width, height};
+        }
+
+        /** Centered inside the slot offered by the page. */
+        RenderContext onArrange(const RenderContext &slot, const Size &size) override {
+            return RenderContext(
+                snapToGrid(slot.x + (slot.width - size.width) / 2),
+                snapToGrid(slot.y + (slot.height - size.height) / 2),
+                size.width,
+                size.height
+            );
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             if (!getIsSelected() && !getIsActive()) {
                 return;
@@ -1149,9 +1835,8 @@ namespace EPD {
 
             auto &display = epd.getDisplay();
 
-            // Calculate center position - align to 8-pixel boundaries
-            const int modalX = (ctx.x + (ctx.width - width) / 2 + 7) & ~7;
-            const int modalY = (ctx.y + (ctx.height - height) / 2 + 7) & ~7;
+            const int modalX = ctx.x;
+            const int modalY = ctx.y;
 
             // Draw modal background
 
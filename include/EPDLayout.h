@@ -0,0 +1,350 @@
+#ifndef EPDLAYOUT_H
+#define EPDLAYOUT_H
+
+/**
+ * @file EPDLayout.h
+ * Declarative layout containers for GXUI pages.
+ *
+ * Provides:
+ *  - EPD::LayoutAlign: cross-axis alignment of children inside a container
+ *  - EPD::LayoutContainer: shared child bookkeeping and slot caching
+ *  - EPD::VStack / EPD::HStack: children stacked along one axis with a gap
+ *  - EPD::Grid: children flowed into a fixed number of columns
+ *
+ * Containers use the measure/arrange pass of Renderable. Child slots are
+ * computed once, cached, and only recomputed from the first child whose
+ * measured size changed (children notify their container through
+ * invalidateLayout). Slots are snapped to the layout grid so every child
+ * gets a byte-aligned partial window.
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "EPDRenderable.h"
+
+namespace EPD {
+    /** Placement of a child on the cross axis of its container. */
+    enum class LayoutAlign {
+        START,   ///< Left (stacks of rows) or top (rows of columns)
+        CENTER,  ///< Centered in the available cross size
+        END,     ///< Right or bottom edge
+        STRETCH  ///< Child is measured and placed with the full cross size
+    };
+
+    /**
+     * Base class for containers that position child renderables.
+     *
+     * Children added by pointer are not owned (e.g. interactables owned by the
+     * Page); children created through emplace() are owned by the container.
+     */
+    class LayoutContainer : public Renderable {
+    protected:
+        struct Child {
+            Renderable *renderable{nullptr};
+            Size constraint{};            ///< constraint measured with, also the slot size
+            Size slotConstraint{};        ///< constraint the cached slot was placed with
+            Size size{};                  ///< last measured size
+            RenderContext slot{};         ///< cached slot in screen coordinates
+        };
+
+        std::vector<Child> children{};
+        std::vector<std::unique_ptr<Renderable> > ownedChildren{};
+
+        int gap;
+        LayoutAlign align;
+
+        /** First child whose cached slot is stale; size() when all are valid. */
+        size_t firstDirtyChild = 0;
+
+        /** Rect the cached slots were computed for. */
+        RenderContext placedRect = RenderContext();
+
+        [[nodiscard]] bool isGridAligned() const override {
+            return true;
+        }
+
+        /** Compute the content size from the cached child sizes. */
+        virtual Size measureContent(const Size &available) = 0;
+
+        /** Recompute slots of children [from, size()) inside rect. */
+        virtual void placeChildren(const RenderContext &rect, size_t from) = 0;
+
+        /** Set the constraint of every child to the cross size it is stretched to. */
+        virtual void stretchChildren(Controller &epd, const Size &available) = 0;
+
+        Size onMeasure(Controller &epd, const Size &available) override {
+            // Children are measured with the same constraint their slot passes to
+            // executeRender, so the render pass reuses this measure result.
+            if (align == LayoutAlign::STRETCH) {
+                stretchChildren(epd, available);
+            }
+            for (size_t i = 0; i < children.size(); i++) {
+                Child &child = children[i];
+                const Size size = child.renderable->measure(epd, child.constraint);
+                if (size != child.size || child.constraint != child.slotConstraint) {
+                    child.size = size;
+                    child.slotConstraint = child.constraint;
+                    firstDirtyChild = std::min(firstDirtyChild, i);
+                }
+            }
+            return measureContent(available);
+        }
+
+        RenderContext onArrange(const RenderContext &slot, const Size &size) override {
+            const RenderContext rect = Renderable::onArrange(slot, size);
+
+            if (rect.x != placedRect.x || rect.y != placedRect.y ||
+                rect.width != placedRect.width || rect.height != placedRect.height) {
+                firstDirtyChild = 0;
+                placedRect = rect;
+            }
+
+            if (firstDirtyChild < children.size()) {
+                placeChildren(rect, firstDirtyChild);
+                firstDirtyChild = children.size();
+            }
+            return rect;
+        }
+
+        void renderContent(Controller &epd, const RenderContext &ctx) override {
+            for (const auto &child: children) {
+                child.renderable->executeRender(epd, child.slot);
+            }
+        }
+
+        /** Cross-axis offset of a child of the given extent inside the available extent. */
+        [[nodiscard]] int alignOffset(const int available, const int extent) const {
+            switch (align) {
+                case LayoutAlign::CENTER:
+                    return (available - extent) / 2;
+                case LayoutAlign::END:
+                    return available - extent;
+                case LayoutAlign::START:
+                case LayoutAlign::STRETCH:
+                default:
+                    return 0;
+            }
+        }
+
+    public:
+        explicit LayoutContainer(const int gap = 0, const LayoutAlign align = LayoutAlign::START)
+            : gap(gap), align(align) {
+        }
+
+        /** Add a child owned elsewhere, e.g. an interactable of the page. */
+        LayoutContainer &add(Renderable *child) {
+            if (child == nullptr) return *this;
+
+            child->setLayoutParent(this);
+            firstDirtyChild = std::min(firstDirtyChild, children.size());
+            children.push_back(Child{child});
+            invalidateLayout();
+            return *this;
+        }
+
+        /** Create a child owned by this container, e.g. a nested stack or a component. */
+        template<typename T, typename... Args>
+        T &emplace(Args &&... args) {
+            auto child = std::make_unique<T>(std::forward<Args>(args)...);
+            T &ref = *child;
+            ownedChildren.push_back(std::move(child));
+            add(&ref);
+            return ref;
+        }
+
+        [[nodiscard]] size_t getChildCount() const {
+            return children.size();
+        }
+
+        [[nodiscard]] Renderable *getChild(const size_t index) const {
+            return index < children.size() ? children[index].renderable : nullptr;
+        }
+    };
+
+    /** Children stacked top to bottom. */
+    class VStack : public LayoutContainer {
+    protected:
+        void stretchChildren(Controller &epd, const Size &available) override {
+            int width = available.width;
+            if (width == 0) {
+                for (const auto &child: children) {
+                    width = std::max(width, child.renderable->measure(epd).width);
+                }
+            }
+            for (auto &child: children) {
+                child.constraint = Size{snapToGrid(width), 0};
+            }
+        }
+
+        Size measureContent(const Size &available) override {
+            Size content{};
+            for (size_t i = 0; i < children.size(); i++) {
+                content.width = std::max(content.width, children[i].size.width);
+                content.height += snapToGrid(children[i].size.height) + (i > 0 ? gap : 0);
+            }
+            content.width = std::max(content.width, available.width);
+            return content;
+        }
+
+        void placeChildren(const RenderContext &rect, const size_t from) override {
+            int cursor = rect.y;
+            if (from > 0) {
+                const Child &previous = children[from - 1];
+                cursor = previous.slot.y + snapToGrid(previous.size.height) + gap;
+            }
+
+            for (size_t i = from; i < children.size(); i++) {
+                Child &child = children[i];
+                const int y = snapToGrid(cursor);
+
+                child.slot = RenderContext(
+                    snapToGrid(rect.x + alignOffset(rect.width, child.size.width)),
+                    y,
+                    child.constraint.width,
+                    child.constraint.height
+                );
+                cursor = y + snapToGrid(child.size.height) + gap;
+            }
+        }
+
+    public:
+        using LayoutContainer::LayoutContainer;
+    };
+
+    /** Children placed left to right. */
+    class HStack : public LayoutContainer {
+    protected:
+        void stretchChildren(Controller &epd, const Size &available) override {
+            int height = available.height;
+            if (height == 0) {
+                for (const auto &child: children) {
+                    height = std::max(height, child.renderable->measure(epd).height);
+                }
+            }
+            for (auto &child: children) {
+                child.constraint = Size{0, snapToGrid(height)};
+            }
+        }
+
+        Size measureContent(const Size &available) override {
+            Size content{};
+            for (size_t i = 0; i < children.size(); i++) {
+                content.width += snapToGrid(children[i].size.width) + (i > 0 ? gap : 0);
+                content.height = std::max(content.height, children[i].size.height);
+            }
+            content.height = std::max(content.height, available.height);
+            return content;
+        }
+
+        void placeChildren(const RenderContext &rect, const size_t from) override {
+            int cursor = rect.x;
+            if (from > 0) {
+                const Child &previous = children[from - 1];
+                cursor = previous.slot.x + snapToGrid(previous.size.width) + gap;
+            }
+
+            for (size_t i = from; i < children.size(); i++) {
+                Child &child = children[i];
+                const int x = snapToGrid(cursor);
+
+                child.slot = RenderContext(
+                    x,
+                    snapToGrid(rect.y + alignOffset(rect.height, child.size.height)),
+                    child.constraint.width,
+                    child.constraint.height
+                );
+                cursor = x + snapToGrid(child.size.width) + gap;
+            }
+        }
+
+    public:
+        using LayoutContainer::LayoutContainer;
+    };
+
+    /**
+     * Children flowed row by row into a fixed number of columns. Column
+     * widths and row heights follow the largest child in that column/row.
+     */
+    class Grid : public LayoutContainer {
+        int columns;
+        int rowGap;
+        std::vector<int> columnWidths{};
+        std::vector<int> rowHeights{};
+
+        /** Size columns and rows to the largest of the given child sizes. */
+        template<typename SizeOf>
+        void sizeTracks(SizeOf sizeOf) {
+            const size_t rows = (children.size() + columns - 1) / columns;
+            columnWidths.assign(columns, 0);
+            rowHeights.assign(rows, 0);
+
+            for (size_t i = 0; i < children.size(); i++) {
+                const Size size = sizeOf(i);
+                const size_t column = i % columns;
+                const size_t row = i / columns;
+                columnWidths[column] = std::max(columnWidths[column], snapToGrid(size.width));
+                rowHeights[row] = std::max(rowHeights[row], snapToGrid(size.height));
+            }
+        }
+
+    protected:
+        void stretchChildren(Controller &epd, const Size &) override {
+            // Cells are sized from the unconstrained measure. Children cache it apart from
+            // the measure with their cell size, so a pass without changes measures nothing.
+            sizeTracks([&](const size_t i) { return children[i].renderable->measure(epd); });
+            for (size_t i = 0; i < children.size(); i++) {
+                children[i].constraint = Size{columnWidths[i % columns], rowHeights[i / columns]};
+            }
+        }
+
+        Size measureContent(const Size &available) override {
+            sizeTracks([&](const size_t i) { return children[i].size; });
+
+            Size content{};
+            for (size_t c = 0; c < columnWidths.size(); c++) {
+                content.width += columnWidths[c] + (c > 0 ? gap : 0);
+            }
+            for (size_t r = 0; r < rowHeights.size(); r++) {
+                content.height += rowHeights[r] + (r > 0 ? rowGap : 0);
+            }
+            return content;
+        }
+
+        void placeChildren(const RenderContext &rect, size_t) override {
+            // A changed cell can resize its whole row and column, so the grid is re-placed as a whole
+            int y = rect.y;
+            for (size_t i = 0; i < children.size(); i++) {
+                const size_t column = i % columns;
+                const size_t row = i / columns;
+                if (column == 0 && i != 0) {
+                    y += rowHeights[row - 1] + rowGap;
+                }
+
+                int x = rect.x;
+                for (size_t c = 0; c < column; c++) {
+                    x += columnWidths[c] + gap;
+                }
+
+                Child &child = children[i];
+                child.slot = RenderContext(
+                    snapToGrid(x + alignOffset(columnWidths[column], child.size.width)),
+                    snapToGrid(y + alignOffset(rowHeights[row], child.size.height)),
+                    child.constraint.width,
+                    child.constraint.height
+                );
+            }
+        }
+
+    public:
+        explicit Grid(
+            const int columns,
+            const int columnGap = 0,
+            const int rowGap = 0,
+            const LayoutAlign align = LayoutAlign::START
+        ) : LayoutContainer(columnGap, align), columns(std::max(1, columns)), rowGap(rowGap) {
+        }
+    };
+}
+#endif //EPDLAYOUT_H
@@ -15,8 +15,15 @@
 #include "EPDController.h"
 #include "EPDPage.h"
 #include "EPDMenuConstants.h"
+#include "EPDMenuSearch.h"
+#include "EPDMenuTree.h"
 #include "EPDInteractable.h"
 #include "EPDRenderManager.h"
+#include "EPDString.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <utility>
 #include <vector>
 #include <functional>
@@ -25,54 +32,99 @@
 namespace EPD {
     class MenuWidget : public Component {
     protected:
-        String data{};
+        Label data{};
         Icon *icon = nullptr;
 
+        static constexpr int PADDING = 4;
+        uint16_t textHeight = 0;
+
+        /** Widgets are packed by the menu bar, which already positions them exactly. */
+        [[nodiscard]] bool isGridAligned() const override {
+            return false;
+        }
+
+        /** Defined after MenuSystem, whose main font the widget row is drawn in. */
+        Size onMeasure(Controller &epd, const Size &available) override;
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
             if (icon != nullptr) {
                 icon->executeRender(epd, IconRenderContext(ctx.x, ctx.y, ctx.height, epd.getPrimaryColor()));
             }
             if (data.length() > 0) {
-                const int PADDING = 4;
                 const int OFFSET = icon != nullptr ? ctx.height + PADDING : 0;
 
-                // Calculate text height to align vertically with icon
-                int16_t x1, y1;
-                uint16_t textWidth, textHeight;
-                epd.getDisplay().getTextBounds(data, 0, 0, &x1, &y1, &textWidth, &textHeight);
-
                 // Adjust y position to vertically align text with icon
                 int textY = ctx.y + ((ctx.height + textHeight) / 2) - 2; // -2 is a small offset adjustment
                 epd.getDisplay().setCursor(ctx.x + OFFSET, textY);
-                epd.getDisplay().print(data);
-
-                // Update context width (icon width + spacing + text width)
-                ctx.width = OFFSET + PADDING + textWidth;
-            } else if (icon != nullptr) {
-                // If only icon, width is just the icon size
-                ctx.width = ctx.height;
+                epd.getDisplay().print(data.c_str());
             }
         }
 
     public:
         explicit MenuWidget() = default;
 
-        explicit MenuWidget(const String &data) : data(data) {
+        explicit MenuWidget(const StringRef data) : data(data) {
         }
 
-        explicit MenuWidget(const String &data, Icon &icon) : data(data), icon(&icon) {
+        explicit MenuWidget(const StringRef data, Icon &icon) : data(data), icon(&icon) {
         }
 
         explicit MenuWidget(Icon &icon) : icon(&icon) {
         }
 
         [[nodiscard]] const Icon *getIcon() const { return icon; }
-    };
 
-    enum class MenuItemType {
-        ACTION,
-        SUBMENU,
-        PAGE,
+        [[nodiscard]] StringRef getData() const { return data; }
+
+        /** Change the text, e.g. from the refresh callback; it is measured again on the next render. */
+        void setData(const StringRef text) {
+            data = text;
+            invalidateLayout();
+        }
+
+        /**
+         * Keep the widget fresh on its own while the menu is open, e.g. a
+         * clock or battery level. Every intervalMs update is called and
+         * returns whether the value changed (typically after setData()); only
+         * then is the widget's part of the menu redrawn.
+         *
+         * The callback runs on the render task, or on the task calling
+         * MenuSystem::open() for the first value, never concurrently with
+         * itself or with drawing the widget. It holds up the display while it
+         * runs, so it should only read a value that is already at hand: read
+         * data written by other tasks through atomics or a copy taken under
+         * their lock, never wait for a sensor or bus, and do not request
+         * renders or draw from it.
+         */
+        void setRefresh(const uint32_t intervalMs, Callback<bool(MenuWidget &)> callback) {
+            refreshInterval = intervalMs;
+            update = std::move(callback);
+            nextRefresh = 0;
+        }
+
+        [[nodiscard]] bool hasRefresh() const {
+            return refreshInterval > 0 && update;
+        }
+
+        /** Whether the next refresh is due at or before time. */
+        [[nodiscard]] bool isRefreshDue(const uint32_t time) const {
+            return hasRefresh() && static_cast<int32_t>(nextRefresh - time) <= 0;
+        }
+
+        [[nodiscard]] uint32_t getNextRefresh() const {
+            return nextRefresh;
+        }
+
+        /** Run the update callback and schedule the next one. @return whether the value changed */
+        bool refresh(const uint32_t now) {
+            nextRefresh = now + refreshInterval;
+            return update(*this);
+        }
+
+    private:
+        uint32_t refreshInterval = 0;
+        uint32_t nextRefresh = 0;
+        Callback<bool(MenuWidget &)> update{};
     };
 
     struct MenuRenderContext final : RenderContext {
@@ -83,31 +135,39 @@ namespace EPD {
 
     class MenuItem : public Interactable {
     public:
-        explicit MenuItem(String title) : title(std::move(title)), parent(nullptr) {
+        explicit MenuItem(const StringRef title) : title(title), parent(nullptr) {
         }
 
-        explicit MenuItem(String title, Icon &icon) : title(std::move(title)),
+        explicit MenuItem(const StringRef title, Icon &icon) : title(title),
                                                       parent(nullptr), icon(&icon) {
         }
 
+        /** Cells are placed by the menu grid, which already positions them exactly. */
+        [[nodiscard]] bool isGridAligned() const override {
+            return false;
+        }
+
         void renderContent(Controller &epd, const RenderContext &ctx) override {
-            const auto &menuCtx = static_cast<const MenuRenderContext &>(ctx);
+            renderCell(epd, static_cast<const MenuRenderContext &>(ctx), icon, getMenuTypeChar(getMenuType()),
+                       getIsSelected());
+        }
 
-            if (getIcon() != nullptr) {
+        /** Grid cell of an item: icon, border (thicker when selected) and marker, see getMenuTypeChar(). */
+        static void renderCell(Controller &epd, const MenuRenderContext &menuCtx, Icon *icon,
+                               const char *marker, const bool selected) {
+            if (icon != nullptr) {
                 const int icon_x = menuCtx.x - (MenuConstants::PADDING / 2) + (menuCtx.menuItemSize - menuCtx.iconSize)
                                    / 2;
                 const int icon_y = menuCtx.y - (MenuConstants::PADDING / 2) + (menuCtx.menuItemSize - menuCtx.iconSize)
                                    / 2;
 
-                if (icon != nullptr) {
-                    icon->executeRender(
-                        epd,
-                        IconRenderContext(icon_x, icon_y, menuCtx.iconSize, epd.getPrimaryColor())
-                    );
-                }
+                icon->executeRender(
+                    epd,
+                    IconRenderContext(icon_x, icon_y, menuCtx.iconSize, epd.getPrimaryColor())
+                );
             }
 
-            /*if (getIsSelected()) {
+            /*if (selected) {
                 epd.drawPatternInRoundedArea(
                     menuCtx.x,
                     menuCtx.y,
@@ -124,7 +184,7 @@ namespace EPD {
                 menuCtx.menuItemSize - MenuConstants::PADDING,
                 menuCtx.menuItemSize - MenuConstants::PADDING,
                 epd.getPrimaryColor(),
-                getIsSelected() ? 3 : 1,
+                selected ? 3 : 1,
                 1,
                 2,
                 MenuConstants::PADDING / 2
@@ -135,16 +195,21 @@ namespace EPD {
                 menuCtx.y + MenuConstants::PADDING * 2.5
             );
 
-            epd.getDisplay().print(getMenuTypeChar(getMenuType()));
+            epd.getDisplay().print(marker);
         }
 
         ~MenuItem() override = default;
 
-        [[nodiscard]] String getTitle() const { return title; }
+        [[nodiscard]] StringRef getTitle() const { return title; }
 
-        [[nodiscard]] String getPathTitle() const {
-            if (parent == nullptr) return title;
-            return parent->getPathTitle() + "/" + title;
+        /** Append the breadcrumb ("Root/Sub/Item") to out, truncated to its capacity. */
+        template<size_t Capacity>
+        void appendPathTitle(FixedString<Capacity> &out) const {
+            if (parent != nullptr) {
+                parent->appendPathTitle(out);
+                out.append('/');
+            }
+            out.append(title);
         }
 
         void setParent(MenuItem *p) { parent = p; }
@@ -155,7 +220,7 @@ namespace EPD {
 
         virtual void execute() = 0;
 
-        static String getMenuTypeChar(const MenuItemType type) {
+        static const char *getMenuTypeChar(const MenuItemType type) {
             switch (type) {
                 case MenuItemType::ACTION: return "$";
                 case MenuItemType::SUBMENU: return "/";
@@ -165,17 +230,17 @@ namespace EPD {
         }
 
     protected:
-        String title = "Item";
+        Label title = "Item";
         MenuItem *parent;
         Icon *icon = nullptr;
     };
 
     class SubMenu : public MenuItem {
     public:
-        explicit SubMenu(const String &title) : MenuItem(title) {
+        explicit SubMenu(const StringRef title) : MenuItem(title) {
         }
 
-        explicit SubMenu(const String &title, Icon &icon) : MenuItem(title, icon) {
+        explicit SubMenu(const StringRef title, Icon &icon) : MenuItem(title, icon) {
         }
 
         [[nodiscard]] MenuItemType getMenuType() const override { return MenuItemType::SUBMENU; }
@@ -210,6 +275,24 @@ namespace EPD {
             return selectedIndex;
         }
 
+        /** First item of the page of cells holding the selection. */
+        [[nodiscard]] int getFirstVisibleIndex() const {
+            return MenuConstants::getPageIndex(selectedIndex) * MenuConstants::VISIBLE_ITEMS;
+        }
+
+        /** One past the last item shown on the current page. */
+        [[nodiscard]] int getLastVisibleIndex() const {
+            return std::min(getFirstVisibleIndex() + MenuConstants::VISIBLE_ITEMS, getItemsSize());
+        }
+
+        [[nodiscard]] int getPageIndex() const {
+            return MenuConstants::getPageIndex(selectedIndex);
+        }
+
+        [[nodiscard]] int getPageCount() const {
+            return MenuConstants::getPageCount(getItemsSize());
+        }
+
     private:
         int selectedIndex = 0;
         std::vector<std::unique_ptr<MenuItem> > items;
@@ -217,11 +300,11 @@ namespace EPD {
 
     class ActionMenuItem : public MenuItem {
     public:
-        ActionMenuItem(const String &title, std::function<void()> action)
+        ActionMenuItem(const StringRef title, Callback<void()> action)
             : MenuItem(title), action(std::move(action)) {
         }
 
-        ActionMenuItem(const String &title, Icon &icon, std::function<void()> action)
+        ActionMenuItem(const StringRef title, Icon &icon, Callback<void()> action)
             : MenuItem(title, icon), action(std::move(action)) {
         }
 
@@ -229,58 +312,159 @@ namespace EPD {
         void execute() override { action(); }
 
     private:
-        std::function<void()> action{};
+        Callback<void()> action{};
     };
 
+    /**
+     * Menu entry opening a page. The page is either resident (constructed
+     * up front and kept) or built by a PageFactory each time it is opened
+     * and released again when it is popped, see lazyPage().
+     */
     class PageMenuItem : public MenuItem {
     public:
-        explicit PageMenuItem(const String &title, std::shared_ptr<Page> page)
+        explicit PageMenuItem(const StringRef title, std::shared_ptr<Page> page)
             : MenuItem(title), page(std::move(page)) {
         }
 
-        PageMenuItem(const String &title, Icon &icon, std::shared_ptr<Page> page)
+        PageMenuItem(const StringRef title, Icon &icon, std::shared_ptr<Page> page)
             : MenuItem(title, icon), page(std::move(page)) {
         }
 
+        PageMenuItem(const StringRef title, PageFactory factory)
+            : MenuItem(title), factory(std::move(factory)) {
+        }
+
+        PageMenuItem(const StringRef title, Icon &icon, PageFactory factory)
+            : MenuItem(title, icon), factory(std::move(factory)) {
+        }
+
         [[nodiscard]] MenuItemType getMenuType() const override { return MenuItemType::PAGE; }
 
         void execute() override {
         }
 
+        /** The resident page, nullptr for pages built by a factory. */
         [[nodiscard]] std::shared_ptr<Page> getPage() const { return page; }
 
+        /** The page to push: the resident one, or a newly constructed one. */
+        [[nodiscard]] std::shared_ptr<Page> openPage() const {
+            return page != nullptr ? page : factory ? factory() : nullptr;
+        }
+
     private:
         std::shared_ptr<Page> page{};
+        PageFactory factory{};
     };
 
+    /**
+     * The menu overlay. Its items come either from a tree of MenuItems built
+     * at runtime (init() and addToRoot()) or from a MenuNode table in flash
+     * (init(nodes)), see EPDMenuTree.h. Navigation and rendering go through
+     * the "level" helpers, which read whichever of the two is in use.
+     */
     class MenuSystem : public Interactable {
     public:
+        /** Font of the menu text and the widget row. */
+        static const GFXfont *getMainFont() {
+            return MAIN_FONT;
+        }
+
         static void init() {
             instance().rootMenu = std::make_unique<SubMenu>("");
             instance().currentMenu = instance().rootMenu.get();
         }
 
+        /**
+         * Use a menu tree from flash instead of MenuItems. The selection of
+         * every submenu is kept in a static array, so nothing is allocated.
+         */
+        template<size_t N>
+        static void init(const MenuNode (&nodes)[N]) {
+            static uint16_t selection[N];
+            instance().tree.attach(nodes, N, selection);
+            instance().rootMenu.reset();
+            instance().currentMenu = nullptr;
+            rebuildSearchIndex();
+        }
+
         [[nodiscard]] InteractableType getType() const override {
             return InteractableType::MENU;
         }
 
-        static bool isActive;
+        /** Written by the input task and read by the render task. */
+        static std::atomic<bool> isActive;
 
         static void open() {
-            isActive = true;
+            // Widgets show current values when the menu appears, then follow their own interval
+            {
+                const WidgetLock lock;
+                const uint32_t now = millis();
+                for (const auto &widget: instance().widgets) {
+                    if (widget->hasRefresh()) widget->refresh(now);
+                }
+                isActive = true;
+            }
             requestRender();
         }
 
         static void close() {
             isActive = false;
+            instance().search.active = false;
+            instance().drawnLevel = nullptr;
             requestRender(true);
         }
 
         static void addToRoot(std::unique_ptr<MenuItem> item) {
+            if (instance().rootMenu == nullptr) {
+                Serial.println("MenuSystem uses a menu tree, items cannot be added");
+                return;
+            }
             instance().rootMenu->addItem(std::move(item));
+            instance().searchIndex.clear();
+        }
+
+        /**
+         * Enter quick-jump search, opening the menu if needed. The grid then
+         * offers the characters that continue the typed prefix and, once few
+         * items are left (or "*" is chosen), the matching items themselves;
+         * choosing one jumps to it. Up removes a character and leaves search
+         * at an empty prefix. Bind it to a button or a menu action.
+         */
+        static void openSearch() {
+            auto &menu = instance();
+            if (!menu.searchIndex.isBuilt()) {
+                rebuildSearchIndex();
+            }
+            menu.search.active = true;
+            menu.search.prefix.clear();
+            menu.updateSearch(false);
+            open();
+        }
+
+        [[nodiscard]] static bool isSearching() {
+            return instance().search.active;
+        }
+
+        /**
+         * Index the titles of all items for openSearch(). Runs on the first
+         * search and for flash trees in init(); call it again after adding
+         * items below the root of a runtime tree that was searched before.
+         */
+        static void rebuildSearchIndex() {
+            auto &menu = instance();
+            menu.searchIndex.clear();
+            if (menu.tree.isAttached()) {
+                for (size_t node = 1; node < menu.tree.getSize(); node++) {
+                    menu.searchIndex.add(menu.tree.getNode(node).title, nullptr, static_cast<uint16_t>(node));
+                }
+            } else if (menu.rootMenu != nullptr) {
+                menu.indexItems(*menu.rootMenu);
+            }
+            menu.searchIndex.finish();
         }
 
         static void addWidget(std::unique_ptr<MenuWidget> widget) {
+            const WidgetLock lock;
             instance().widgets.push_back(std::move(widget));
         }
 
@@ -304,51 +488,110 @@ namespace EPD {
             executeSelected();
         }
 
-        static void moveSelection(bool up) {
-            if (auto *subMenu = static_cast<SubMenu *>(instance().currentMenu)) {
-                const int itemCount = subMenu->getItems().size();
-                if (up) {
-                    subMenu->setSelectedIndex(
-                        (subMenu->getSelectedIndex() > 0)
-                            ? subMenu->getSelectedIndex() - 1
-                            : itemCount - 1
-                    );
-                } else {
-                    subMenu->setSelectedIndex(
-                        (subMenu->getSelectedIndex() < itemCount - 1)
-                            ? subMenu->getSelectedIndex() + 1
-                            : 0
-                    );
+        /**
+         * Tap on the overlay: a menu cell selects and executes it, a tap
+         * outside the overlay closes the menu. Only the cells of the current
+         * page are on screen, so only those are checked.
+         */
+        bool onTouch(const int x, const int y) override {
+            if (!isActive) return false;
+
+            auto &epd = Controller::getInstance();
+            const RenderContext overlay(
+                MenuConstants::X_POS,
+                MenuConstants::getYPos(epd),
+                MenuConstants::getWidth(epd),
+                MenuConstants::HEIGHT
+            );
+            if (!overlay.contains(x, y)) {
+                close();
+                return true;
+            }
+
+            auto &menu = instance();
+            for (int i = menu.getFirstVisibleIndex(); i < menu.getLastVisibleIndex(); i++) {
+                if (menu.getCellBounds(epd, i).contains(x, y)) {
+                    menu.setLevelSelection(i);
+                    executeSelected();
+                    break;
                 }
             }
+            return true;
+        }
+
+        static void moveSelection(bool up) {
+            auto &menu = instance();
+            const int itemCount = menu.getLevelSize();
+            if (itemCount == 0) return;
+
+            const int selected = menu.getLevelSelection();
+            if (up) {
+                menu.setLevelSelection(selected > 0 ? selected - 1 : itemCount - 1);
+            } else {
+                menu.setLevelSelection(selected < itemCount - 1 ? selected + 1 : 0);
+            }
         }
 
         static void executeSelected() {
-            if (auto *subMenu = static_cast<SubMenu *>(instance().currentMenu)) {
-                if (const auto &items = subMenu->getItems();
-                    subMenu->getSelectedIndex() >= 0 && subMenu->getSelectedIndex() < items.size()) {
-                    auto &selectedItem = items[subMenu->getSelectedIndex()];
-                    if (selectedItem->getMenuType() == MenuItemType::SUBMENU) {
-                        instance().currentMenu = selectedItem.get();
-                        //subMenu->setSelectedIndex(0);
-                    } else if (selectedItem->getMenuType() == MenuItemType::PAGE) {
-                        if (const auto *pageItem = static_cast<PageMenuItem *>(selectedItem.get())) {
-                            RenderManager::pushPage(pageItem->getPage());
-                            close();
+            auto &menu = instance();
+            const int selected = menu.getLevelSelection();
+            if (selected < 0 || selected >= menu.getLevelSize()) return;
+
+            if (menu.search.active) {
+                menu.executeSearchChoice(selected);
+                return;
+            }
+
+            if (menu.tree.isAttached()) {
+                const MenuNode &node = menu.tree.getChild(selected);
+                switch (node.type) {
+                    case MenuItemType::SUBMENU:
+                        menu.tree.enter(selected);
+                        break;
+                    case MenuItemType::PAGE:
+                        if (const auto page = node.openPage()) {
+                            RenderManager::pushPage(page);
                         }
-                    }
-                    selectedItem->execute();
+                        close();
+                        break;
+                    case MenuItemType::ACTION:
+                        node.action();
+                        break;
+                }
+                return;
+            }
 
-                    if (selectedItem->getMenuType() != MenuItemType::PAGE) {
-                        //requestRender();
+            const auto *subMenu = static_cast<SubMenu *>(menu.currentMenu);
+            auto &selectedItem = subMenu->getItems()[selected];
+            if (selectedItem->getMenuType() == MenuItemType::SUBMENU) {
+                menu.currentMenu = selectedItem.get();
+                //subMenu->setSelectedIndex(0);
+            } else if (selectedItem->getMenuType() == MenuItemType::PAGE) {
+                if (const auto *pageItem = static_cast<PageMenuItem *>(selectedItem.get())) {
+                    if (const auto page = pageItem->openPage()) {
+                        RenderManager::pushPage(page);
                     }
+                    close();
                 }
             }
+            selectedItem->execute();
         }
 
         static void goBack() {
-            if (instance().currentMenu != instance().rootMenu.get() && instance().currentMenu->getParent()) {
-                instance().currentMenu = instance().currentMenu->getParent();
+            auto &menu = instance();
+            if (menu.search.active) {
+                if (menu.search.prefix.isEmpty()) {
+                    menu.leaveSearch();
+                } else {
+                    menu.search.prefix.truncate(menu.search.prefix.length() - 1);
+                    menu.updateSearch(false);
+                }
+            } else if (menu.tree.isAttached()) {
+                if (!menu.tree.back()) {
+                    close();
+                }
+            } else if (menu.currentMenu != menu.rootMenu.get() && menu.currentMenu->getParent()) {
+                menu.currentMenu = menu.currentMenu->getParent();
                 //requestRender();
             } else {
                 close();
@@ -366,7 +609,349 @@ namespace EPD {
                 MenuConstants::PADDING,
                 epd.getPrimaryColor(true)
             );
+            renderBorder(epd);
+
+            renderTitle(epd);
+            renderPageMarkers(epd);
+
+            // Only the page holding the selection is drawn, however long the submenu is
+            for (int i = getFirstVisibleIndex(); i < getLastVisibleIndex(); i++) {
+                renderCell(epd, i);
+            }
+            drawnLevel = getLevel();
+            drawnIndex = getLevelSelection();
+
+            renderWidgets(epd, nullptr);
+        }
+
+        /**
+         * Milliseconds until the next widget refresh is due, UINT32_MAX if the
+         * menu is closed or no widget refreshes on its own.
+         */
+        static uint32_t getWidgetRefreshDelay(const uint32_t now) {
+            const WidgetLock lock;
+            if (!isActive) return UINT32_MAX;
+
+            uint32_t delay = UINT32_MAX;
+            for (const auto &widget: instance().widgets) {
+                if (!widget->hasRefresh()) continue;
+                const int32_t remaining = static_cast<int32_t>(widget->getNextRefresh() - now);
+                delay = std::min<uint32_t>(delay, remaining > 0 ? remaining : 0);
+            }
+            return delay;
+        }
+
+        /**
+         * Refresh the widgets that are due (or nearly, so they share one
+         * update) and compute one window over those whose value changed. A
+         * widget that changed width moves the ones after it, so they are
+         * covered as well.
+         * @return false if nothing on screen has to change
+         */
+        static bool collectWidgetUpdates(Controller &epd, const uint32_t now, RenderContext &window) {
+            auto &menu = instance();
+            window = RenderContext();
+            const WidgetLock lock;
+            if (!isActive) return false;
+
+            epd.getDisplay().setFont(MAIN_FONT);
+            int widgetX = getGridX();
+            bool shifted = false;
+            for (const auto &widget: menu.widgets) {
+                const RenderContext previous = widget->lastRenderCTX;
+                const bool changed = widget->isRefreshDue(now + WIDGET_COALESCE_MS) && widget->refresh(now);
+                if (changed) {
+                    widget->invalidateLayout();
+                }
+
+                // Lay out again without drawing to find where the widget goes now
+                const RenderContext &rect = widget->layout(epd, menu.getWidgetSlot(epd, widgetX));
+                shifted = shifted || rect.x != previous.x || rect.width != previous.width;
+                if (changed || shifted) {
+                    window = window.united(previous).united(rect);
+                }
+                widgetX += rect.width;
+            }
+            // Otherwise the new values show with the next render of the whole menu
+            if (menu.drawnLevel == nullptr) return false;
+            return !window.isEmpty();
+        }
+
+        /**
+         * Draw the widgets within window, see collectWidgetUpdates(). The
+         * widget row has the menu background around it, so the byte-aligned
+         * panel window is cleared to it first.
+         */
+        static void renderWidgetUpdates(Controller &epd, const RenderContext &window) {
+            const RenderContext panel = epd.getDisplay().getWindowBounds();
+            epd.getDisplay().fillRect(panel.x, panel.y, panel.width, panel.height, epd.getPrimaryColor(true));
+            instance().renderWidgets(epd, &window);
+        }
+
+        /**
+         * Windows to redraw after the selection moved within the page on
+         * screen: the title line, the previously selected cell and the newly
+         * selected one (neighbouring cells share a window). The caller draws
+         * each with renderSelectionRegion().
+         * @return 0 if the whole menu has to be drawn instead
+         */
+        static size_t collectSelectionRegions(Controller &epd, RenderContext *regions, const size_t capacity) {
+            auto &menu = instance();
+            menu.selectionRegionCount = 0;
+            if (!isActive || capacity < MAX_SELECTION_REGIONS ||
+                menu.drawnLevel == nullptr || menu.drawnLevel != menu.getLevel()) {
+                return 0;
+            }
+
+            const int previous = menu.drawnIndex;
+            const int selected = menu.getLevelSelection();
+            if (previous == selected || previous < 0 || previous >= menu.getLevelSize() ||
+                MenuConstants::getPageIndex(previous) != MenuConstants::getPageIndex(selected)) {
+                return 0;
+            }
+
+            auto &selection = menu.selectionRegions;
+            selection[0] = {menu.getTitleBounds(epd, selected), -1};
+            selection[1] = {menu.getCellBounds(epd, std::min(previous, selected)), std::min(previous, selected)};
+            selection[2] = {menu.getCellBounds(epd, std::max(previous, selected)), std::max(previous, selected)};
+            size_t count = 3;
+            if (std::abs(previous - selected) == 1) {
+                // Neighbours: one window over both cells and the gap between them
+                selection[1].bounds = selection[1].bounds.united(selection[2].bounds);
+                selection[1].lastCell = selection[2].cell;
+                count = 2;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                regions[i] = selection[i].bounds;
+            }
+            menu.selectionRegionCount = count;
+            menu.drawnIndex = selected;
+            return count;
+        }
+
+        /** Draw one window of collectSelectionRegions(). */
+        static void renderSelectionRegion(Controller &epd, const size_t index) {
+            auto &menu = instance();
+            if (index >= menu.selectionRegionCount || menu.getLevel() != menu.drawnLevel) return;
+
+            // The byte-aligned panel window is larger than the region; around cells it only
+            // covers menu background, above the title line it reaches into the border
+            const SelectionRegion &region = menu.selectionRegions[index];
+            const RenderContext panel = epd.getDisplay().getWindowBounds();
+            epd.getDisplay().fillRect(panel.x, panel.y, panel.width, panel.height, epd.getPrimaryColor(true));
+
+            if (region.cell < 0) {
+                // The breadcrumb stays, only the selected item's part of the title line is drawn
+                menu.renderBorder(epd);
+                menu.renderSelectedTitle(epd);
+                menu.renderPageNumber(epd);
+                return;
+            }
+            const int lastCell = region.lastCell >= 0 ? region.lastCell : region.cell;
+            for (int i = region.cell; i <= lastCell; i++) {
+                menu.renderCell(epd, i);
+            }
+        }
+
+        static MenuSystem &instance() {
+            static MenuSystem inst;
+            return inst;
+        }
+
+    private:
+        /** A window of a selection move: the title line (cell < 0) or the cells cell..lastCell. */
+        struct SelectionRegion {
+            RenderContext bounds;
+            int cell = -1;
+            int lastCell = -1;
+        };
+
+        static constexpr size_t MAX_SELECTION_REGIONS = 3;
+
+        /** Longest search prefix; the characters on offer per step, "*" included. */
+        static constexpr size_t SEARCH_CAPACITY = 15;
+        static constexpr size_t MAX_SEARCH_CHOICES = 48;
+
+        /**
+         * Identifies the submenu on screen: its SubMenu or its MenuNode, or
+         * the search state. Search invalidates what was drawn for it itself
+         * whenever the prefix changes.
+         */
+        [[nodiscard]] const void *getLevel() const {
+            if (search.active) return &search;
+            if (tree.isAttached()) return &tree.getCurrent();
+            return currentMenu;
+        }
+
+        [[nodiscard]] const SubMenu *getSubMenu() const {
+            return currentMenu != nullptr && currentMenu->getMenuType() == MenuItemType::SUBMENU
+                       ? static_cast<const SubMenu *>(currentMenu)
+                       : nullptr;
+        }
+
+        [[nodiscard]] int getLevelSize() const {
+            if (search.active) return search.listing ? search.matches.size() : search.choiceCount;
+            if (tree.isAttached()) return tree.getChildCount();
+            const SubMenu *subMenu = getSubMenu();
+            return subMenu != nullptr ? subMenu->getItemsSize() : 0;
+        }
+
+        [[nodiscard]] int getLevelSelection() const {
+            if (search.active) return search.selected;
+            if (tree.isAttached()) return tree.getSelectedIndex();
+            const SubMenu *subMenu = getSubMenu();
+            return subMenu != nullptr ? subMenu->getSelectedIndex() : 0;
+        }
+
+        void setLevelSelection(const int index) {
+            if (search.active) {
+                search.selected = index;
+            } else if (tree.isAttached()) {
+                tree.setSelectedIndex(index);
+            } else if (getSubMenu() != nullptr) {
+                static_cast<SubMenu *>(currentMenu)->setSelectedIndex(index);
+            }
+        }
+
+        [[nodiscard]] StringRef getItemTitle(const int index) const {
+            if (search.active) {
+                return search.listing ? StringRef(getMatch(index).title) : StringRef(search.choices[index]);
+            }
+            if (tree.isAttached()) return tree.getChild(index).title;
+            return getSubMenu()->getItems()[index]->getTitle();
+        }
+
+        /** Type marker of a cell; search offers characters with "+". */
+        [[nodiscard]] const char *getItemMarker(const int index) const {
+            if (search.active && !search.listing) return "+";
+            return MenuItem::getMenuTypeChar(getItemType(index));
+        }
+
+        [[nodiscard]] MenuItemType getItemType(const int index) const {
+            if (search.active) {
+                const MenuSearchIndex::Entry &match = getMatch(index);
+                return match.item != nullptr
+                           ? static_cast<const MenuItem *>(match.item)->getMenuType()
+                           : tree.getNode(match.node).type;
+            }
+            if (tree.isAttached()) return tree.getChild(index).type;
+            return getSubMenu()->getItems()[index]->getMenuType();
+        }
+
+        /** What the quick-jump search shows, see openSearch(). */
+        struct SearchState {
+            bool active = false;
+            bool listing = false; ///< cells are the matching items rather than next characters
+            FixedString<SEARCH_CAPACITY> prefix{};
+            MenuSearchIndex::Range matches{};
+            char choices[MAX_SEARCH_CHOICES][2]{}; ///< next characters, then "*" to list all matches
+            int choiceCount = 0;
+            int selected = 0;
+        };
+
+        [[nodiscard]] const MenuSearchIndex::Entry &getMatch(const int index) const {
+            return searchIndex[search.matches.first + index];
+        }
 
+        void indexItems(const SubMenu &subMenu) {
+            for (const auto &item: subMenu.getItems()) {
+                searchIndex.add(item->getTitle().c_str(), item.get());
+                if (item->getMenuType() == MenuItemType::SUBMENU) {
+                    indexItems(static_cast<const SubMenu &>(*item));
+                }
+            }
+        }
+
+        /**
+         * Find the matches of the prefix and what to offer next. Few matches
+         * are listed right away; while typing, a prefix with only one way to
+         * continue is extended without asking.
+         */
+        void updateSearch(const bool extend) {
+            while (true) {
+                search.matches = searchIndex.find(search.prefix);
+                search.listing = search.matches.size() <= MenuConstants::VISIBLE_ITEMS;
+                if (search.listing) break;
+
+                char next[MAX_SEARCH_CHOICES - 1];
+                const size_t count = searchIndex.nextCharacters(search.matches, search.prefix.length(), next,
+                                                                sizeof(next));
+                // A title equal to the prefix is only reachable through the list, so stop there
+                const bool prefixIsTitle = strlen(getMatch(0).title) == search.prefix.length();
+                if (extend && count == 1 && !prefixIsTitle && !search.prefix.isFull()) {
+                    search.prefix.append(next[0]);
+                    continue;
+                }
+
+                for (size_t i = 0; i < count; i++) {
+                    search.choices[i][0] = next[i];
+                    search.choices[i][1] = '\0';
+                }
+                search.choices[count][0] = '*';
+                search.choices[count][1] = '\0';
+                search.choiceCount = static_cast<int>(count) + 1;
+                break;
+            }
+            search.selected = 0;
+            // The cells changed as a whole, so the next render draws the menu again
+            drawnLevel = nullptr;
+            pathLevel = nullptr;
+        }
+
+        void executeSearchChoice(const int index) {
+            if (search.listing) {
+                jumpTo(getMatch(index));
+                return;
+            }
+            if (index == search.choiceCount - 1) {
+                search.listing = true;
+                search.selected = 0;
+                drawnLevel = nullptr;
+                return;
+            }
+            if (!search.prefix.isFull()) {
+                search.prefix.append(search.choices[index][0]);
+            }
+            updateSearch(true);
+        }
+
+        /** Leave search with the item selected in its own submenu. */
+        void jumpTo(const MenuSearchIndex::Entry &match) {
+            if (match.item == nullptr) {
+                tree.select(match.node);
+            } else {
+                const auto *item = static_cast<const MenuItem *>(match.item);
+                auto *parent = static_cast<SubMenu *>(item->getParent());
+                const auto &items = parent->getItems();
+                for (int i = 0; i < parent->getItemsSize(); i++) {
+                    if (items[i].get() == item) {
+                        currentMenu = parent;
+                        parent->setSelectedIndex(i);
+                        break;
+                    }
+                }
+            }
+            leaveSearch();
+        }
+
+        void leaveSearch() {
+            search.active = false;
+            drawnLevel = nullptr;
+            pathLevel = nullptr;
+        }
+
+        /** First item of the page of cells holding the selection. */
+        [[nodiscard]] int getFirstVisibleIndex() const {
+            return MenuConstants::getPageIndex(getLevelSelection()) * MenuConstants::VISIBLE_ITEMS;
+        }
+
+        /** One past the last item shown on the current page. */
+        [[nodiscard]] int getLastVisibleIndex() const {
+            return std::min(getFirstVisibleIndex() + MenuConstants::VISIBLE_ITEMS, getLevelSize());
+        }
+
+        static void renderBorder(Controller &epd) {
             epd.drawMultiRoundRectBorder(
                 MenuConstants::X_POS,
                 MenuConstants::getYPos(epd),
@@ -378,124 +963,322 @@ namespace EPD {
                 2,
                 MenuConstants::PADDING
             );
+        }
 
+        [[nodiscard]] static int getGridX() {
+            return MenuConstants::X_POS + (MenuConstants::PADDING * 2) + MenuConstants::PADDING / 2;
+        }
+
+        [[nodiscard]] static int getGridY(Controller &epd) {
+            return MenuConstants::getYPos(epd) + MenuConstants::HEIGHT - MenuConstants::MARGIN_BOTTOM -
+                   getCellSize(epd) - (MenuConstants::PADDING * 1.5);
+        }
+
+        [[nodiscard]] static int getCellSize(Controller &epd) {
+            return (MenuConstants::getWidth(epd) - MenuConstants::PADDING * 4) / MenuConstants::VISIBLE_ITEMS;
+        }
+
+        /** Cell of item index, which must be on the current page. */
+        [[nodiscard]] RenderContext getCellBounds(Controller &epd, const int index) const {
+            const int size = getCellSize(epd);
+            return RenderContext(
+                getGridX() + (index - getFirstVisibleIndex()) * size,
+                getGridY(epd),
+                size - MenuConstants::PADDING,
+                size - MenuConstants::PADDING
+            );
+        }
+
+        /** Where the type marker and underlined title of an item go, after the breadcrumb. */
+        struct TitleLayout {
+            int textX;  ///< cursor x of the title
+            int lineX;  ///< underline from lineX ...
+            int right;  ///< ... to right, exclusive
+        };
+
+        [[nodiscard]] static int getTitleBaseline(Controller &epd) {
+            return MenuConstants::getYPos(epd) + (MenuConstants::PADDING * 3.5);
+        }
+
+        [[nodiscard]] TitleLayout getTitleLayout(Controller &epd, const int index) const {
+            const Controller::Bounds marker = epd.measureText(getItemMarker(index), MAIN_FONT);
+            const Controller::Bounds title = epd.measureText(getItemTitle(index), &FreeMonoBold12pt7b);
+            const int textX = titleX + marker.x + marker.w;
+            return {textX, textX + title.x, textX + title.x + title.w + 1};
+        }
+
+        /**
+         * The part of the title line a selection move changes: from the end
+         * of the breadcrumb to the end of the longer of the old and new title,
+         * from the top of the text to below the underline.
+         */
+        [[nodiscard]] RenderContext getTitleBounds(Controller &epd, const int selected) const {
+            const int right = std::max(drawnTitleRight, getTitleLayout(epd, selected).right);
+            return RenderContext(
+                titleX,
+                MenuConstants::getYPos(epd) + MenuConstants::PADDING,
+                right - titleX,
+                MenuConstants::PADDING * 3.5
+            );
+        }
+
+        /**
+         * Rebuild the breadcrumb and its width when another submenu is shown;
+         * selection moves and redraws of the same submenu reuse them.
+         */
+        void updatePath(Controller &epd) {
+            if (pathLevel == getLevel()) return;
+
+            path.clear();
+            if (search.active) {
+                path.append('?').append(search.prefix);
+            } else if (tree.isAttached()) {
+                tree.appendPathTitle(path);
+            } else {
+                currentMenu->appendPathTitle(path);
+            }
+            const Controller::Bounds bounds = epd.measureText(path, MAIN_FONT);
+            titleX = MenuConstants::X_POS + (MenuConstants::PADDING * 2) + bounds.x + bounds.w;
+            pathLevel = getLevel();
+        }
+
+        /** Breadcrumb, then the selected item and the page number, see renderSelectedTitle(). */
+        void renderTitle(Controller &epd) {
+            updatePath(epd);
 
             epd.getDisplay().setFont(MAIN_FONT);
             epd.getDisplay().setTextColor(
                 epd.getPrimaryColor()
             );
 
-            // Draw title
             epd.getDisplay().setCursor(
                 MenuConstants::X_POS + (MenuConstants::PADDING * 2),
-                MenuConstants::getYPos(epd) + (MenuConstants::PADDING * 3.5)
+                getTitleBaseline(epd)
             );
-            epd.getDisplay().print(
-                currentMenu->getPathTitle()
-            );
-
-            // Draw menu items
+            epd.getDisplay().print(path.c_str());
 
-            const int MENU_ITEM_COUNT = 5;
-            const int MENU_ITEM_SIZE = (MenuConstants::getWidth(epd) - MenuConstants::PADDING * 4) / MENU_ITEM_COUNT;
-            const int MENU_ITEM_ICON_PADDING = MenuConstants::PADDING * 4;
-            const int MENU_ITEM_ICON_SIZE = MENU_ITEM_SIZE - MENU_ITEM_ICON_PADDING;
-
-            int x = MenuConstants::X_POS + (MenuConstants::PADDING * 2) + MenuConstants::PADDING / 2;
-            int y = MenuConstants::getYPos(epd) + MenuConstants::HEIGHT - MenuConstants::MARGIN_BOTTOM - MENU_ITEM_SIZE
-                    - (
-                        MenuConstants::PADDING * 1.5);
+            renderSelectedTitle(epd);
+            renderPageNumber(epd);
+        }
 
-            int itemX = x;
+        /** Type marker and underlined title of the selected item. */
+        void renderSelectedTitle(Controller &epd) {
+            if (getLevelSize() == 0) return;
 
-            // Check if current menu is a submenu using getMenuType()
-            if (currentMenu->getMenuType() == MenuItemType::SUBMENU) {
-                int index = 0;
+            const int selected = getLevelSelection();
+            const TitleLayout layout = getTitleLayout(epd, selected);
+            const int baseline = getTitleBaseline(epd);
 
-                const auto *subMenu = static_cast<const SubMenu *>(currentMenu);
+            epd.getDisplay().setFont(MAIN_FONT);
+            epd.getDisplay().setTextColor(epd.getPrimaryColor());
+            epd.getDisplay().setCursor(titleX, baseline);
+            epd.getDisplay().print(getItemMarker(selected));
 
-                const auto &selectedItem = *subMenu->getItems()[subMenu->getSelectedIndex()];
+            epd.getDisplay().setFont(&FreeMonoBold12pt7b);
+            epd.getDisplay().setCursor(layout.textX, baseline);
+            epd.getDisplay().print(getItemTitle(selected).c_str());
 
-                epd.getDisplay().print(MenuItem::getMenuTypeChar(selectedItem.getMenuType()));
+            // Below the descenders of the font, so the line does not move with the text
+            const int lineY = baseline + FontMetrics::of(&FreeMonoBold12pt7b).descent;
+            epd.getDisplay().drawLine(layout.lineX, lineY, layout.right - 1, lineY, epd.getPrimaryColor());
+            drawnTitleRight = layout.right;
 
-                epd.getDisplay().setFont(&FreeMonoBold12pt7b);
+            epd.getDisplay().setFont(MAIN_FONT);
+        }
 
-                const int16_t cursorX = epd.getDisplay().getCursorX();
-                const int16_t cursorY = epd.getDisplay().getCursorY();
-                int16_t x1, y1;
-                uint16_t w, h;
-                epd.getDisplay().getTextBounds(
-                    subMenu->getItems()[subMenu->getSelectedIndex()]->getTitle(),
-                    cursorX,
-                    cursorY,
-                    &x1,
-                    &y1,
-                    &w,
-                    &h
-                );
-                if (h < 16) {
-                    h = 20;
-                }
+        /** "page/pages" in the top right corner for submenus longer than a page. */
+        void renderPageNumber(Controller &epd) const {
+            const int pageCount = MenuConstants::getPageCount(getLevelSize());
+            if (pageCount <= 1) return;
 
-                epd.getDisplay().drawLine(x1, y1 + h, x1 + w, y1 + h, epd.getPrimaryColor());
+            char text[12];
+            const int length = snprintf(text, sizeof(text), "%d/%d",
+                                        MenuConstants::getPageIndex(getLevelSelection()) + 1, pageCount);
+            const Controller::Bounds bounds = epd.measureText(text, length, MAIN_FONT);
+            epd.getDisplay().setFont(MAIN_FONT);
+            epd.getDisplay().setTextColor(epd.getPrimaryColor());
+            epd.getDisplay().setCursor(
+                MenuConstants::X_POS + MenuConstants::getWidth(epd) - MenuConstants::PADDING * 2 - bounds.w,
+                getTitleBaseline(epd)
+            );
+            epd.getDisplay().print(text);
+        }
 
-                epd.getDisplay().print(selectedItem.getTitle());
+        void renderCell(Controller &epd, const int index) const {
+            const RenderContext cell = getCellBounds(epd, index);
 
-                epd.getDisplay().setFont(MAIN_FONT);
+            epd.getDisplay().setFont(MAIN_FONT);
+            epd.getDisplay().setTextColor(epd.getPrimaryColor());
+
+            MenuRenderContext menuCtx;
+            menuCtx.x = cell.x;
+            menuCtx.y = cell.y;
+            menuCtx.width = cell.width;
+            menuCtx.height = cell.height;
+            menuCtx.menuItemSize = getCellSize(epd);
+            menuCtx.iconSize = menuCtx.menuItemSize - MenuConstants::PADDING * 4;
+            menuCtx.selectedIndex = getLevelSelection();
+
+            const bool selected = index == menuCtx.selectedIndex;
+            if (search.active && !search.listing) {
+                renderCharacterCell(epd, menuCtx, search.choices[index], selected);
+            } else if (search.active) {
+                const MenuSearchIndex::Entry &match = getMatch(index);
+                Icon *icon = match.item != nullptr
+                                 ? static_cast<const MenuItem *>(match.item)->getIcon()
+                                 : tree.getNode(match.node).icon;
+                MenuItem::renderCell(epd, menuCtx, icon, getItemMarker(index), selected);
+            } else if (tree.isAttached()) {
+                const MenuNode &node = tree.getChild(index);
+                MenuItem::renderCell(epd, menuCtx, node.icon, getItemMarker(index), selected);
+            } else {
+                getSubMenu()->getItems()[index]->executeRender(epd, menuCtx);
+            }
+        }
 
-                for (const auto &item: subMenu->getItems()) {
-                    MenuRenderContext menuCtx;
-                    menuCtx.x = itemX;
-                    menuCtx.y = y;
-                    menuCtx.menuItemSize = MENU_ITEM_SIZE;
-                    menuCtx.iconSize = MENU_ITEM_ICON_SIZE;
-                    menuCtx.selectedIndex = subMenu->getSelectedIndex();
+        [[nodiscard]] RenderContext getWidgetSlot(Controller &epd, const int x) const {
+            return RenderContext(x, getGridY(epd) + getCellSize(epd), 0, WIDGET_HEIGHT);
+        }
 
-                    item->executeRender(epd, menuCtx);
+        /** The widget row below the grid; with a window, only the widgets inside it. */
+        void renderWidgets(Controller &epd, const RenderContext *window) {
+            const WidgetLock lock;
+            epd.getDisplay().setFont(MAIN_FONT);
+            epd.getDisplay().setTextColor(epd.getPrimaryColor());
 
-                    itemX += MENU_ITEM_SIZE;
-                    index++;
+            int widgetX = getGridX();
+            for (const auto &widget: widgets) {
+                const RenderContext widgetCtx = getWidgetSlot(epd, widgetX);
+                const RenderContext &rect = widget->layout(epd, widgetCtx);
+                if (window == nullptr || (rect.x < window->x + window->width && window->x < rect.x + rect.width)) {
+                    widget->executeRender(epd, widgetCtx);
                 }
+                widgetX += rect.width;
             }
+        }
 
-            if (!widgets.empty()) {
-                int widgetX = x;
-                const int widgetY = y + MENU_ITEM_SIZE;
+        /** A search cell offering the next character, drawn large in the middle of the cell. */
+        static void renderCharacterCell(Controller &epd, const MenuRenderContext &menuCtx, const char *character,
+                                        const bool selected) {
+            MenuItem::renderCell(epd, menuCtx, nullptr, "+", selected);
 
-                for (const auto &widget: widgets) {
-                    const RenderContext widgetCtx;
-                    widgetCtx.x = widgetX;
-                    widgetCtx.y = widgetY;
-                    widgetCtx.height = 20;
-                    widget->executeRender(epd, widgetCtx);
-                    int wX, wY, wWidth, wHeight;
-                    widget->getWindow(&wX, &wY, &wWidth, &wHeight);
-
-                    widgetX += wWidth;
-                }
-            }
+            const Controller::Bounds bounds = epd.measureText(character, &FreeMonoBold12pt7b);
+            epd.getDisplay().setFont(&FreeMonoBold12pt7b);
+            epd.getDisplay().setCursor(
+                menuCtx.x + (menuCtx.width - bounds.w) / 2 - bounds.x,
+                menuCtx.y + (menuCtx.height - bounds.h) / 2 - bounds.y
+            );
+            epd.getDisplay().print(character);
+            epd.getDisplay().setFont(MAIN_FONT);
         }
 
-        static MenuSystem &instance() {
-            static MenuSystem inst;
-            return inst;
+        /** A marker beside the grid towards each page that is not shown. */
+        void renderPageMarkers(Controller &epd) const {
+            const int pageCount = MenuConstants::getPageCount(getLevelSize());
+            if (pageCount <= 1) return;
+
+            const int pageIndex = MenuConstants::getPageIndex(getLevelSelection());
+            const int markerY = getGridY(epd) + getCellSize(epd) / 2;
+            // Between the overlay border and the first/last cell
+            const int markerSize = MenuConstants::PADDING / 2;
+            if (pageIndex > 0) {
+                const int markerX = MenuConstants::X_POS + MenuConstants::PADDING + 2;
+                epd.getDisplay().fillTriangle(
+                    markerX, markerY,
+                    markerX + markerSize, markerY - markerSize,
+                    markerX + markerSize, markerY + markerSize,
+                    epd.getPrimaryColor()
+                );
+            }
+            if (pageIndex < pageCount - 1) {
+                const int markerX = MenuConstants::X_POS + MenuConstants::getWidth(epd) - MenuConstants::PADDING - 2;
+                epd.getDisplay().fillTriangle(
+                    markerX, markerY,
+                    markerX - markerSize, markerY - markerSize,
+                    markerX - markerSize, markerY + markerSize,
+                    epd.getPrimaryColor()
+                );
+            }
         }
 
-    private:
         static void requestRender(const bool fullRender = false) {
             fullRender ? RenderManager::requestFullRender() : RenderManager::requestMenuRender();
         }
 
+        /**
+         * Held while widgets are added, refreshed, laid out or drawn: open() and
+         * addWidget() run on the input task, the refresh pass on the render task.
+         * Recursive, so a refresh callback may add a widget.
+         */
+        struct WidgetLock {
+            WidgetLock() {
+                xSemaphoreTakeRecursive(mutex(), portMAX_DELAY);
+            }
+
+            ~WidgetLock() {
+                xSemaphoreGiveRecursive(mutex());
+            }
+
+            WidgetLock(const WidgetLock &) = delete;
+
+            WidgetLock &operator=(const WidgetLock &) = delete;
+
+        private:
+            static SemaphoreHandle_t mutex() {
+                static const SemaphoreHandle_t handle = xSemaphoreCreateRecursiveMutex();
+                return handle;
+            }
+        };
+
+        /** Guarded by WidgetLock. */
         std::vector<std::unique_ptr<MenuWidget> > widgets;
+        static constexpr int WIDGET_HEIGHT = 20;
+        /** Widgets due within this many milliseconds are refreshed together with the due ones. */
+        static constexpr uint32_t WIDGET_COALESCE_MS = 250;
 
         std::unique_ptr<SubMenu> rootMenu;
         MenuItem *currentMenu{nullptr};
+        /** Position in the flash menu tree, if init(nodes) was used. */
+        MenuTreeCursor tree{};
+
+        MenuSearchIndex searchIndex{};
+        SearchState search{};
         static const GFXfont *MAIN_FONT;
+        /** Longest breadcrumb shown in the menu title; deeper paths are cut off. */
+        static constexpr size_t PATH_CAPACITY = 63;
+
+        /** Breadcrumb of pathLevel and where the selected item's title starts after it, see updatePath(). */
+        const void *pathLevel{nullptr};
+        FixedString<PATH_CAPACITY> path{};
+        int titleX{0};
+        /** Right end of the title as last drawn, so a shorter one can be cleared. */
+        int drawnTitleRight{0};
+
+        /** What the menu on screen shows, so a selection move can redraw just the cells that changed. */
+        const void *drawnLevel{nullptr};
+        int drawnIndex{-1};
+        SelectionRegion selectionRegions[MAX_SELECTION_REGIONS];
+        size_t selectionRegionCount{0};
     };
 
-    bool MenuSystem::isActive = false;
+    std::atomic<bool> MenuSystem::isActive{false};
     const GFXfont *MenuSystem::MAIN_FONT = &FreeMono12pt7b;
 
+    inline Size MenuWidget::onMeasure(Controller &epd, const Size &available) {
+        if (data.length() > 0) {
+            const int OFFSET = icon != nullptr ? available.height + PADDING : 0;
+
+            // Height above the baseline, to align the text vertically with the icon
+            const Controller::Bounds text = epd.measureText(data.c_str(), data.length(), MenuSystem::getMainFont());
+            textHeight = static_cast<uint16_t>(-text.y);
+
+            // Icon width + spacing + text width
+            return {OFFSET + PADDING + text.w, available.height};
+        }
+        // If only icon, width is just the icon size
+        return {icon != nullptr ? available.height : 0, available.height};
+    }
+
     inline bool isMenuActive() {
         return MenuSystem::isActive;
     }
@@ -503,4 +1286,24 @@ namespace EPD {
     inline Interactable &getMenuSystemInstance() {
         return MenuSystem::instance();
     }
+
+    inline size_t getMenuSelectionRegions(Controller &epd, RenderContext *regions, const size_t capacity) {
+        return MenuSystem::collectSelectionRegions(epd, regions, capacity);
+    }
+
+    inline void renderMenuSelectionRegion(Controller &epd, const size_t index) {
+        MenuSystem::renderSelectionRegion(epd, index);
+    }
+
+    inline uint32_t getMenuWidgetRefreshDelay(const uint32_t now) {
+        return MenuSystem::getWidgetRefreshDelay(now);
+    }
+
+    inline bool collectMenuWidgetUpdates(Controller &epd, const uint32_t now, RenderContext &window) {
+        return MenuSystem::collectWidgetUpdates(epd, now, window);
+    }
+
+    inline void renderMenuWidgetUpdates(Controller &epd, const RenderContext &window) {
+        MenuSystem::renderWidgetUpdates(epd, window);
+    }
 }
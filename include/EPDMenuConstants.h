@@ -14,6 +14,17 @@ namespace EPD {
         static constexpr int MARGIN_BOTTOM = 20;
         static constexpr int HEIGHT = 140 + MARGIN_BOTTOM;
         static constexpr int X_POS = PADDING;
+        /** Cells in the menu grid; longer submenus are shown one page of cells at a time. */
+        static constexpr int VISIBLE_ITEMS = 5;
+
+        /** Page of cells that shows item index. */
+        [[nodiscard]] static constexpr int getPageIndex(const int index) {
+            return index / VISIBLE_ITEMS;
+        }
+
+        [[nodiscard]] static constexpr int getPageCount(const int items) {
+            return (items + VISIBLE_ITEMS - 1) / VISIBLE_ITEMS;
+        }
 
         [[nodiscard]] static int getWidth(Controller &epd) {
             return epd.getDisplay().width() - PADDING * 2;
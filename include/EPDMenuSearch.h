@@ -0,0 +1,132 @@
+#ifndef EPDMENUSEARCH_H
+#define EPDMENUSEARCH_H
+
+/**
+ * @file EPDMenuSearch.h
+ * Sorted index over menu item titles for the quick-jump search.
+ *
+ * Titles are sorted case-insensitively, so all items starting with a prefix
+ * form one contiguous range that is found with two binary searches, and the
+ * characters that may follow the prefix come out grouped and in order. The
+ * index only keeps pointers to the titles, which the menu items (or the
+ * flash MenuNode table) own.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "EPDString.h"
+
+namespace EPD {
+    class MenuSearchIndex {
+    public:
+        struct Entry {
+            const char *title;
+            const void *item; ///< the MenuItem of a runtime tree, nullptr for a flash tree
+            uint16_t node;    ///< index into the MenuNode table of a flash tree
+        };
+
+        /** Half-open range of entries [first, last). */
+        struct Range {
+            size_t first = 0;
+            size_t last = 0;
+
+            [[nodiscard]] size_t size() const {
+                return last - first;
+            }
+        };
+
+        void clear() {
+            entries.clear();
+            built = false;
+        }
+
+        void add(const char *title, const void *item, const uint16_t node = 0) {
+            entries.push_back(Entry{title, item, node});
+        }
+
+        /** Sort the entries added since clear(); the index is usable afterwards. */
+        void finish() {
+            std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+                return compare(a.title, b.title) < 0;
+            });
+            entries.shrink_to_fit();
+            built = true;
+        }
+
+        [[nodiscard]] bool isBuilt() const {
+            return built;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return entries.size();
+        }
+
+        [[nodiscard]] const Entry &operator[](const size_t index) const {
+            return entries[index];
+        }
+
+        /** Entries whose title starts with prefix, ignoring case. */
+        [[nodiscard]] Range find(const StringRef prefix) const {
+            const auto first = std::partition_point(entries.begin(), entries.end(), [&](const Entry &entry) {
+                return comparePrefix(entry.title, prefix) < 0;
+            });
+            const auto last = std::partition_point(first, entries.end(), [&](const Entry &entry) {
+                return comparePrefix(entry.title, prefix) == 0;
+            });
+            return {static_cast<size_t>(first - entries.begin()), static_cast<size_t>(last - entries.begin())};
+        }
+
+        /**
+         * The distinct characters at position length of the titles in range,
+         * lowercased and in order, e.g. the letters that may follow a prefix
+         * of that length.
+         * @return how many were written, at most capacity
+         */
+        size_t nextCharacters(const Range range, const size_t length, char *out, const size_t capacity) const {
+            size_t count = 0;
+            for (size_t i = range.first; i < range.last && count < capacity; i++) {
+                const char *title = entries[i].title;
+                if (strlen(title) <= length) continue;
+
+                const char c = lower(title[length]);
+                if (count == 0 || out[count - 1] != c) {
+                    out[count++] = c;
+                }
+            }
+            return count;
+        }
+
+    private:
+        std::vector<Entry> entries{};
+        bool built = false;
+
+        static char lower(const char c) {
+            return static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+
+        static int compare(const char *a, const char *b) {
+            for (;; a++, b++) {
+                const char ca = lower(*a);
+                const char cb = lower(*b);
+                if (ca != cb || ca == '\0') return static_cast<unsigned char>(ca) - static_cast<unsigned char>(cb);
+            }
+        }
+
+        /** Compare the first prefix.length() characters of title with prefix. */
+        static int comparePrefix(const char *title, const StringRef prefix) {
+            const char *p = prefix.c_str();
+            for (size_t i = 0; i < prefix.length(); i++) {
+                const char ct = lower(title[i]);
+                const char cp = lower(p[i]);
+                if (ct != cp) return static_cast<unsigned char>(ct) - static_cast<unsigned char>(cp);
+            }
+            return 0;
+        }
+    };
+}
+#endif //EPDMENUSEARCH_H
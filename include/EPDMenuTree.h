@@ -0,0 +1,244 @@
+#ifndef EPDMENUTREE_H
+#define EPDMENUTREE_H
+
+/**
+ * @file EPDMenuTree.h
+ * Menu trees described at compile time, kept in flash.
+ *
+ * A tree is a constexpr array of EPD::MenuNode: node 0 is the root, and each
+ * submenu names the range of the array holding its children. Titles, icons
+ * and actions are plain pointers, so a static constexpr table ends up in
+ * flash and building the menu costs no heap and no boot time:
+ *
+ *   static constexpr MenuNode MENU[] = {
+ *       menuSubmenu("", 1, 3),                     // 0: root, children 1..3
+ *       menuPage("Demo", createPage<DemoPage>),    // 1
+ *       menuSubmenu("System", 4, 1),               // 2: children 4..4
+ *       menuAction("Refresh", &refreshNow),        // 3
+ *       menuAction("Restart", &ESP.restart),       // 4
+ *   };
+ *   static_assert(isValidMenuTree(MENU), "broken menu tree");
+ *   MenuSystem::init(MENU);
+ *
+ * What changes at runtime (the selected item of every submenu and the path
+ * from the root) lives in an EPD::MenuTreeCursor instead of in the nodes.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "EPDIcon.h"
+#include "EPDPage.h"
+#include "EPDString.h"
+
+namespace EPD {
+    enum class MenuItemType {
+        ACTION,
+        SUBMENU,
+        PAGE,
+    };
+
+    using MenuAction = void (*)();
+    using MenuPageOpener = std::shared_ptr<Page> (*)();
+
+    struct MenuNode {
+        const char *title;
+        MenuItemType type;
+        Icon *icon;
+        MenuAction action;       ///< ACTION: called when executed
+        MenuPageOpener openPage; ///< PAGE: constructs the page to push
+        uint16_t firstChild;     ///< SUBMENU: index of the first child in the table
+        uint16_t childCount;     ///< SUBMENU: children at firstChild, firstChild + 1, ...
+    };
+
+    constexpr MenuNode menuSubmenu(const char *title, const uint16_t firstChild, const uint16_t childCount,
+                                   Icon *icon = nullptr) {
+        return MenuNode{title, MenuItemType::SUBMENU, icon, nullptr, nullptr, firstChild, childCount};
+    }
+
+    constexpr MenuNode menuAction(const char *title, const MenuAction action, Icon *icon = nullptr) {
+        return MenuNode{title, MenuItemType::ACTION, icon, action, nullptr, 0, 0};
+    }
+
+    constexpr MenuNode menuPage(const char *title, const MenuPageOpener openPage, Icon *icon = nullptr) {
+        return MenuNode{title, MenuItemType::PAGE, icon, nullptr, openPage, 0, 0};
+    }
+
+    /** Page opener for menuPage(): constructs a P each time the page is opened. */
+    template<typename P>
+    std::shared_ptr<Page> createPage() {
+        return std::make_shared<P>();
+    }
+
+    /**
+     * Page opener for menuPage() whose widget-bound values live in a static
+     * State, see lazyPageWithState(). The State is created on first use.
+     */
+    template<typename P, typename State>
+    std::shared_ptr<Page> createPageWithState() {
+        static State state;
+        return std::make_shared<P>(state);
+    }
+
+    /**
+     * Whether the root is a submenu and every submenu has children that lie
+     * behind it in the table, which also rules out cycles. Meant for a
+     * static_assert next to the table.
+     */
+    template<size_t N>
+    constexpr bool isValidMenuTree(const MenuNode (&nodes)[N]) {
+        if (N == 0 || N > UINT16_MAX || nodes[0].type != MenuItemType::SUBMENU) return false;
+        for (size_t i = 0; i < N; i++) {
+            const MenuNode &node = nodes[i];
+            if (node.title == nullptr) return false;
+            switch (node.type) {
+                case MenuItemType::SUBMENU:
+                    if (node.childCount == 0 || node.firstChild <= i || node.firstChild + node.childCount > N) {
+                        return false;
+                    }
+                    break;
+                case MenuItemType::ACTION:
+                    if (node.action == nullptr) return false;
+                    break;
+                case MenuItemType::PAGE:
+                    if (node.openPage == nullptr) return false;
+                    break;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Position in a flash menu tree: the submenus from the root to the
+     * current one, and the selected child of every submenu. The selection
+     * array is owned by the caller, one entry per node.
+     */
+    class MenuTreeCursor {
+    public:
+        /** Deepest nesting of submenus below the root that can be entered. */
+        static constexpr size_t MAX_DEPTH = 8;
+
+        void attach(const MenuNode *treeNodes, const size_t treeSize, uint16_t *treeSelection) {
+            nodes = treeNodes;
+            size = treeSize;
+            selection = treeSelection;
+            for (size_t i = 0; i < size; i++) {
+                selection[i] = 0;
+            }
+            path[0] = 0;
+            depth = 0;
+        }
+
+        [[nodiscard]] bool isAttached() const {
+            return nodes != nullptr;
+        }
+
+        [[nodiscard]] size_t getSize() const {
+            return size;
+        }
+
+        [[nodiscard]] const MenuNode &getNode(const size_t index) const {
+            return nodes[index];
+        }
+
+        [[nodiscard]] bool isRoot() const {
+            return depth == 0;
+        }
+
+        /** The submenu whose children are listed. */
+        [[nodiscard]] const MenuNode &getCurrent() const {
+            return nodes[path[depth]];
+        }
+
+        [[nodiscard]] int getChildCount() const {
+            return getCurrent().childCount;
+        }
+
+        [[nodiscard]] const MenuNode &getChild(const int index) const {
+            return nodes[getCurrent().firstChild + index];
+        }
+
+        [[nodiscard]] int getSelectedIndex() const {
+            return selection[path[depth]];
+        }
+
+        void setSelectedIndex(const int index) {
+            selection[path[depth]] = static_cast<uint16_t>(index);
+        }
+
+        /** Descend into child index. @return false if it is no submenu or the tree is too deep */
+        bool enter(const int index) {
+            if (index < 0 || index >= getChildCount() || depth + 1 >= MAX_DEPTH) return false;
+            if (getChild(index).type != MenuItemType::SUBMENU) return false;
+
+            path[depth + 1] = static_cast<uint16_t>(getCurrent().firstChild + index);
+            depth++;
+            return true;
+        }
+
+        /** Go up to the parent submenu. @return false at the root */
+        bool back() {
+            if (depth == 0) return false;
+            depth--;
+            return true;
+        }
+
+        /**
+         * Show the submenu holding node, with node selected, e.g. for a search
+         * result. The parents are looked up by scanning the table.
+         * @return false for the root, a node outside the tree or one nested too deep
+         */
+        bool select(const uint16_t node) {
+            uint16_t chain[MAX_DEPTH];
+            size_t count = 0;
+            for (uint16_t child = node; child != 0;) {
+                const size_t parent = findParent(child);
+                if (parent >= size || count == MAX_DEPTH) return false;
+                chain[count++] = static_cast<uint16_t>(parent);
+                child = static_cast<uint16_t>(parent);
+            }
+            if (count == 0) return false;
+
+            // chain runs from the direct parent up to the root
+            for (size_t level = 0; level < count; level++) {
+                path[level] = chain[count - 1 - level];
+            }
+            depth = count - 1;
+            for (size_t level = 0; level < depth; level++) {
+                selection[path[level]] = static_cast<uint16_t>(path[level + 1] - nodes[path[level]].firstChild);
+            }
+            selection[path[depth]] = static_cast<uint16_t>(node - nodes[path[depth]].firstChild);
+            return true;
+        }
+
+        /** Append the breadcrumb ("Root/Sub") to out, truncated to its capacity. */
+        template<size_t Capacity>
+        void appendPathTitle(FixedString<Capacity> &out) const {
+            for (size_t level = 0; level <= depth; level++) {
+                if (level > 0) out.append('/');
+                out.append(nodes[path[level]].title);
+            }
+        }
+
+    private:
+        /** Submenu whose child range holds child, size if there is none. */
+        [[nodiscard]] size_t findParent(const uint16_t child) const {
+            for (size_t i = 0; i < size; i++) {
+                const MenuNode &candidate = nodes[i];
+                if (candidate.type == MenuItemType::SUBMENU && child >= candidate.firstChild &&
+                    child < candidate.firstChild + candidate.childCount) {
+                    return i;
+                }
+            }
+            return size;
+        }
+
+        const MenuNode *nodes = nullptr;
+        size_t size = 0;
+        uint16_t *selection = nullptr;
+        uint16_t path[MAX_DEPTH] = {};
+        size_t depth = 0;
+    };
+}
+#endif //EPDMENUTREE_H
@@ -0,0 +1,82 @@
+#ifndef EPDOVERLAY_H
+#define EPDOVERLAY_H
+
+/**
+ * @file EPDOverlay.h
+ * Saved-under compositing for elements drawn above the page.
+ *
+ * When an overlay (an open modal, an expanded dropdown) is first drawn, the
+ * screen content under it is copied from the display's shadow frame. While
+ * it stays open the saved pixels are put back before the overlay redraws,
+ * and when it closes they are restored alone, so neither step runs the
+ * page's render code or refreshes more than the overlay's area.
+ */
+
+#include "EPDDisplay.h"
+#include "EPDInteractable.h"
+
+namespace EPD {
+    class OverlayLayer {
+        const Interactable *owner = nullptr;
+        const Interactable *page = nullptr;
+        Display::FrameRegion under{};
+
+    public:
+        /**
+         * Save the screen under area for an overlay about to be drawn.
+         * @return false if the display keeps no shadow frame
+         */
+        bool open(Display &display, const Interactable *overlay, const Interactable *ownerPage,
+                  const RenderContext &area) {
+            close();
+            if (!display.captureRegion(area, under)) return false;
+            owner = overlay;
+            page = ownerPage;
+            return true;
+        }
+
+        void close() {
+            owner = nullptr;
+            page = nullptr;
+            under.bits.clear();
+        }
+
+        [[nodiscard]] bool isOpen() const {
+            return owner != nullptr;
+        }
+
+        [[nodiscard]] bool isOpenFor(const Interactable *overlay) const {
+            return owner != nullptr && owner == overlay;
+        }
+
+        [[nodiscard]] const Interactable *getOwner() const {
+            return owner;
+        }
+
+        /** The overlay closed on its page, so the saved pixels are still what belongs under it. */
+        [[nodiscard]] bool canRestore(const Interactable *currentPage) const {
+            return owner != nullptr && page == currentPage && !owner->isOverlay();
+        }
+
+        /** Whether a redraw window lies inside the saved area. */
+        [[nodiscard]] bool covers(const Display &display, const RenderContext &area) const {
+            if (owner == nullptr) return false;
+            const RenderContext saved = display.logicalBounds(under);
+            return area.x >= saved.x && area.y >= saved.y &&
+                   area.x + area.width <= saved.x + saved.width &&
+                   area.y + area.height <= saved.y + saved.height;
+        }
+
+        [[nodiscard]] RenderContext getBounds(const Display &display) const {
+            return owner != nullptr ? display.logicalBounds(under) : RenderContext();
+        }
+
+        /** Put the saved pixels back; only the current partial window is written. */
+        void restore(Display &display) const {
+            if (owner != nullptr) {
+                display.restoreRegion(under);
+            }
+        }
+    };
+}
+#endif //EPDOVERLAY_H
@@ -10,8 +10,15 @@
  * by ID or index and a hook for when the page is opened.
  */
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string> // for std::string and std::hash
 #include <EPDInteractable.h>
+#include "EPDArena.h"
+#include "EPDString.h"
+#include "EPDSpatialIndex.h"
 
 //#include <EPDMenu.h>
 namespace std
@@ -29,6 +36,37 @@ namespace std
 
 namespace EPD
 {
+    /** Deletes heap interactables and only destroys those living in a page arena. */
+    struct InteractableDeleter
+    {
+        bool inArena = false;
+
+        void operator()(Interactable* interactable) const
+        {
+            if (inArena)
+            {
+                interactable->~Interactable();
+            }
+            else
+            {
+                delete interactable;
+            }
+        }
+    };
+
+    using InteractablePtr = std::unique_ptr<Interactable, InteractableDeleter>;
+
+    /** Orders IDs by their text, so a map of them can be searched with a literal or StringRef. */
+    struct IdLess
+    {
+        using is_transparent = void;
+
+        bool operator()(const StringRef a, const StringRef b) const
+        {
+            return strcmp(a.c_str(), b.c_str()) < 0;
+        }
+    };
+
     class Page : public Interactable
     {
     public:
@@ -41,7 +79,8 @@ namespace EPD
         {
         }
 
-        [[nodiscard]] virtual String getTitle() const = 0;
+        /** Title text, e.g. a string literal; it must outlive the page. */
+        [[nodiscard]] virtual StringRef getTitle() const = 0;
 
         /**
          * @brief Determines if the page should render content when it's not focused.
@@ -61,7 +100,87 @@ namespace EPD
             return true;
         }
 
+        /**
+         * @brief Marks the page content as changed outside of input handling.
+         *
+         * The last frame of a page is kept while another page covers it, so
+         * going back can show it without rendering. Call this when the page's
+         * content changes while it is covered, e.g. from a background task, so
+         * the kept frame is no longer used.
+         */
+        void markStateChanged()
+        {
+            stateVersion++;
+        }
+
+        [[nodiscard]] uint32_t getStateVersion() const
+        {
+            return stateVersion;
+        }
+
+        /**
+         * @brief Number unique to this page instance, never 0.
+         *
+         * Unlike the address, it is not reused by a page allocated after this
+         * one is released, so it can key data kept about a page, e.g. its frame.
+         */
+        [[nodiscard]] uint32_t getSerial() const
+        {
+            return serial;
+        }
+
+        /**
+         * @brief Opts the page into allocating its interactables from an arena.
+         *
+         * Call it in the constructor before adding interactables. Interactables
+         * created with emplaceInteractable() then share chunks of chunkSize
+         * bytes that go back to the heap in one step when the page is destroyed,
+         * instead of one heap block each. getArena() reports the high-water mark
+         * to size the chunks.
+         */
+        void enableArena(const size_t chunkSize = Arena::DEFAULT_CHUNK_SIZE)
+        {
+            if (arena == nullptr)
+            {
+                arena.reset(new Arena(chunkSize));
+            }
+        }
+
+        /** The page arena, nullptr unless enableArena() was called. */
+        [[nodiscard]] const Arena* getArena() const
+        {
+            return arena.get();
+        }
+
+        /**
+         * @brief Constructs an interactable in the page arena, or on the heap
+         * without one, and adds it as focusable.
+         *
+         * @return the interactable, or nullptr for a duplicate ID
+         */
+        template <typename T, typename... Args>
+        T* emplaceInteractable(Args&&... args)
+        {
+            if (arena == nullptr)
+            {
+                return static_cast<T*>(addInteractable(std::make_unique<T>(std::forward<Args>(args)...)));
+            }
+
+            T* interactable = arena->create<T>(std::forward<Args>(args)...);
+            if (interactable == nullptr)
+            {
+                Serial.println("Page arena exhausted");
+                return nullptr;
+            }
+            return static_cast<T*>(addInteractable(InteractablePtr(interactable, InteractableDeleter{true})));
+        }
+
         Interactable* addInteractable(std::unique_ptr<Interactable> interactable, const bool focusable = true)
+        {
+            return addInteractable(InteractablePtr(interactable.release()), focusable);
+        }
+
+        Interactable* addInteractable(InteractablePtr interactable, const bool focusable = true)
         {
             const String id = interactable->getId();
             if (interactableMap.find(id) != interactableMap.end())
@@ -82,16 +201,18 @@ namespace EPD
             interactableMap[id] = interactables.size();
             interactables.push_back(std::move(interactable));
 
-            return interactable.get();
+            return interactables.back().get();
         }
 
-        Interactable* getInteractable(const String& id)
+        /** Lookup by ID; a literal is searched as is, without building a String, e.g. from renderContent. */
+        Interactable* getInteractable(const StringRef id)
         {
             const auto it = interactableMap.find(id);
             return (it != interactableMap.end()) ? interactables[it->second].get() : nullptr;
         }
 
-        Interactable* getInteractable(const size_t index)
+        /** Lookup by insertion order, see getInteractablesSize(). */
+        Interactable* getInteractableAt(const size_t index)
         {
             return (index < interactables.size()) ? interactables[index].get() : nullptr;
         }
@@ -119,7 +240,7 @@ namespace EPD
         }
 
 
-        [[nodiscard]] const std::vector<std::unique_ptr<Interactable>>& getInteractables() { return interactables; }
+        [[nodiscard]] const std::vector<InteractablePtr>& getInteractables() { return interactables; }
         [[nodiscard]] int getInteractablesSize() const { return interactables.size(); }
 
 
@@ -134,41 +255,124 @@ namespace EPD
 
         void onActionLeft() override
         {
+            moveFocus(FocusDirection::LEFT);
         };
 
         void onActionRight() override
         {
+            moveFocus(FocusDirection::RIGHT);
         };
 
+        /**
+         * Up and down move spatially from a focused target. Without one (a
+         * fresh page, or the focused interactable got hidden or disabled)
+         * they step in insertion order instead of doing nothing.
+         */
         void onActionUp() override
         {
-            if (interactables.empty()) return;
-
-            int newIndex = currentInteractableIndex;
-            do
+            if (hasFocusStart())
             {
-                newIndex--;
-                if (newIndex < 0) return;
+                moveFocus(FocusDirection::UP);
+                return;
             }
-            while (!interactables[newIndex]->getIsInteractable());
-
-            setSelectedIndex(newIndex);
+            stepFocus(-1);
         };
 
         void onActionDown() override
         {
-            if (interactables.empty()) return;
+            if (hasFocusStart())
+            {
+                moveFocus(FocusDirection::DOWN);
+                return;
+            }
+            stepFocus(1);
+        };
 
-            int newIndex = currentInteractableIndex;
-            do
+        /**
+         * @brief Moves focus to the nearest interactable in the given direction.
+         *
+         * Uses the painted rectangles of the last layout pass, so a single press
+         * reaches the widget visually next to the current one (e.g. across
+         * columns). The spatial index is rebuilt only when one of them changed.
+         *
+         * @return true if the focus moved
+         */
+        bool moveFocus(const FocusDirection direction)
+        {
+            if (!hasFocusGeometry()) return false;
+
+            const auto it = std::find(focusTargets.begin(), focusTargets.end(), currentInteractableIndex);
+            if (it == focusTargets.end()) return false;
+
+            const int next = focusIndex.nearestInDirection(it - focusTargets.begin(), direction);
+            if (next < 0) return false;
+
+            setSelectedIndex(focusTargets[next]);
+            return true;
+        }
+
+        /**
+         * @brief Topmost focusable interactable painted at the given point.
+         *
+         * Candidates come from the spatial focus index; interactables added
+         * later are drawn later and therefore win on overlap.
+         *
+         * @return the interactable index, or -1 if nothing was hit
+         */
+        int hitTest(const int x, const int y)
+        {
+            if (!hasFocusGeometry()) return -1;
+
+            int hit = -1;
+            focusIndex.query(RenderContext(x, y, 1, 1), [&](const size_t id)
             {
-                newIndex++;
-                if (newIndex >= getInteractablesSize()) return;
+                const int index = focusTargets[id];
+                if (index > hit && interactables[index]->getPaintBounds().contains(x, y))
+                {
+                    hit = index;
+                }
+                return true;
+            });
+            return hit;
+        }
+
+        /**
+         * @brief Focuses the tapped interactable and forwards the tap to it.
+         */
+        bool onTouch(const int x, const int y) override
+        {
+            const int index = hitTest(x, y);
+            if (index < 0) return false;
+
+            if (index != currentInteractableIndex)
+            {
+                setSelectedIndex(index);
             }
-            while (!interactables[newIndex]->getIsInteractable());
+            interactables[index]->onTouch(x, y);
+            return true;
+        }
 
-            setSelectedIndex(newIndex);
-        };
+        /**
+         * @brief Whether focusable interactables have been laid out yet.
+         *
+         * Before the first render there is no geometry and the page falls back
+         * to stepping through interactables in insertion order.
+         */
+        [[nodiscard]] bool hasFocusGeometry()
+        {
+            if (focusBoundsChanged())
+            {
+                rebuildFocusIndex();
+            }
+            return !focusTargets.empty();
+        }
+
+        /** Whether the focused interactable is a target the spatial index can move from. */
+        [[nodiscard]] bool hasFocusStart()
+        {
+            return hasFocusGeometry() &&
+                   std::find(focusTargets.begin(), focusTargets.end(), currentInteractableIndex) != focusTargets.end();
+        }
 
         void onAction() override
         {
@@ -236,10 +440,129 @@ namespace EPD
             resetFocus();
         }
 
-        std::unordered_map<String, size_t> interactableMap{};
-        std::vector<std::unique_ptr<Interactable>> interactables;
+        /**
+         * Linear focus step in insertion order, skipping non-focusable items.
+         * Without a focused item it starts at the first or, stepping back, the last one.
+         */
+        void stepFocus(const int step)
+        {
+            if (interactables.empty()) return;
+
+            int newIndex = currentInteractableIndex;
+            if (newIndex < 0 || newIndex >= getInteractablesSize())
+            {
+                newIndex = step > 0 ? -1 : getInteractablesSize();
+            }
+            do
+            {
+                newIndex += step;
+                if (newIndex < 0 || newIndex >= getInteractablesSize()) return;
+            }
+            while (!interactables[newIndex]->getIsInteractable());
+
+            setSelectedIndex(newIndex);
+        }
+
+        /**
+         * Area an interactable can be focused or tapped in: what it paints, or
+         * nothing when it is not interactable or paints nothing (e.g. a hidden modal).
+         */
+        [[nodiscard]] RenderContext focusBounds(const size_t index) const
+        {
+            if (!interactables[index]->getIsInteractable()) return RenderContext();
+
+            const RenderContext bounds = interactables[index]->getPaintBounds();
+            return bounds.isEmpty() ? RenderContext() : bounds;
+        }
+
+        /** Whether any focus area differs from the one the index was built from. */
+        [[nodiscard]] bool focusBoundsChanged() const
+        {
+            if (indexedBounds.size() != interactables.size()) return true;
+
+            for (size_t i = 0; i < interactables.size(); i++)
+            {
+                const RenderContext bounds = focusBounds(i);
+                const RenderContext& indexed = indexedBounds[i];
+                if (bounds.x != indexed.x || bounds.y != indexed.y ||
+                    bounds.width != indexed.width || bounds.height != indexed.height)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void rebuildFocusIndex()
+        {
+            std::vector<RenderContext> rects;
+            indexedBounds.clear();
+            focusTargets.clear();
+            for (size_t i = 0; i < interactables.size(); i++)
+            {
+                indexedBounds.push_back(focusBounds(i));
+                if (indexedBounds.back().isEmpty()) continue;
+
+                rects.push_back(indexedBounds.back());
+                focusTargets.push_back(static_cast<int>(i));
+            }
+            focusIndex.build(rects);
+        }
+
+        /** Declared before the interactables so it is released after they are destroyed. */
+        std::unique_ptr<Arena> arena{};
+        std::map<String, size_t, IdLess> interactableMap{};
+        std::vector<InteractablePtr> interactables;
         int currentInteractableIndex = -1;
         int tempInteractableIndex = -1;
+
+        /** Spatial index over focusable interactables, see moveFocus(). */
+        SpatialIndex focusIndex{};
+        std::vector<int> focusTargets{}; ///< index entry -> interactable index
+        std::vector<RenderContext> indexedBounds{}; ///< focusBounds() per interactable at the last build
+
+        /** Bumped by markStateChanged(), may be called from other tasks. */
+        std::atomic<uint32_t> stateVersion{0};
+
+        const uint32_t serial = nextSerial();
+
+        static uint32_t nextSerial()
+        {
+            static std::atomic<uint32_t> counter{0};
+            return ++counter;
+        }
     };
+
+    /**
+     * Constructs a page when it is opened. Pages pushed from a factory are
+     * owned by the page stack alone and released when they are popped.
+     */
+    using PageFactory = std::function<std::shared_ptr<Page>()>;
+
+    /** Factory for a page constructed on demand from copies of args. */
+    template <typename P, typename... Args>
+    PageFactory lazyPage(Args... args)
+    {
+        return [args...]()
+        {
+            return std::make_shared<P>(args...);
+        };
+    }
+
+    /**
+     * Factory for a page constructed on demand whose widget-bound values
+     * live in a State kept by the factory, e.g. slider values or dropdown
+     * indices. P is constructed with a State & and binds its widgets to it,
+     * so the values survive the page being released and opened again.
+     */
+    template <typename P, typename State>
+    PageFactory lazyPageWithState()
+    {
+        auto state = std::make_shared<State>();
+        return [state]()
+        {
+            return std::make_shared<P>(*state);
+        };
+    }
 }
 #endif
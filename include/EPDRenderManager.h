@@ -14,8 +14,12 @@
 #include <EPDInteractable.h>
 #include <EPDRenderable.h>
 
+#include "EPDAllocationCounter.h"
 #include "EPDController.h"
+#include "EPDFrameCache.h"
 #include "EPDMenuConstants.h"
+#include "EPDOverlay.h"
+#include "EPDTouch.h"
 
 namespace EPD {
     class MenuSystem;
@@ -24,6 +28,16 @@ namespace EPD {
 
     extern Interactable &getMenuSystemInstance();
 
+    extern size_t getMenuSelectionRegions(Controller &epd, RenderContext *regions, size_t capacity);
+
+    extern void renderMenuSelectionRegion(Controller &epd, size_t index);
+
+    extern uint32_t getMenuWidgetRefreshDelay(uint32_t now);
+
+    extern bool collectMenuWidgetUpdates(Controller &epd, uint32_t now, RenderContext &window);
+
+    extern void renderMenuWidgetUpdates(Controller &epd, const RenderContext &window);
+
     enum class RenderFocus {
         PAGE,
         MENU,
@@ -49,13 +63,30 @@ namespace EPD {
             requestFullRender();
         }
 
+        /** Construct a page and push it; the stack is its only owner, so popPage() releases it. */
+        static void pushPage(const PageFactory &factory) {
+            if (const auto page = factory()) {
+                pushPage(page);
+            }
+        }
+
+        /** Go back; the previous page shows its kept frame if its state did not change meanwhile. */
         static void popPage() {
             if (!pageStack.empty()) {
+                const uint32_t popped = pageStack.top()->getSerial();
                 pageStack.pop();
-                requestFullRender();
+                requestBackRender(popped);
             }
         }
 
+        /**
+         * Bytes the compressed frames of covered pages may take. Call before
+         * init(); 0 disables the cache.
+         */
+        static void setFrameCacheBudget(const size_t bytes) {
+            instance().frameCache.setBudget(bytes);
+        }
+
         static void requestFullRender() {
             if (!isInitialized()) {
                 Serial.println("RenderManager not initialized!");
@@ -175,15 +206,68 @@ namespace EPD {
             requestContextualRender();
         }
 
+        /**
+         * Feed one raw touch sample from the touch controller. Coordinates are
+         * in native panel orientation and mapped through the display rotation.
+         * Completed taps go to the topmost layer: the menu overlay, then an
+         * active interactable (modal, expanded dropdown, ...), then the page.
+         */
+        static void onTouchStatic(const TouchEvent &event) {
+            if (instance().epd == nullptr) return;
+
+            int x, y;
+            TouchTransform::forDisplay(instance().epd->getDisplay()).toLogical(event.x, event.y, x, y);
+
+            int tapX, tapY;
+            if (instance().touchTapDetector.feed(event.phase, x, y, tapX, tapY)) {
+                onTapStatic(tapX, tapY);
+            }
+        }
+
+        /** Route a tap at logical coordinates, see onTouchStatic(). */
+        static void onTapStatic(const int x, const int y) {
+            switch (getCurrentRenderFocus()) {
+                case RenderFocus::MENU:
+                    getMenuSystemInstance().onTouch(x, y);
+                    break;
+                case RenderFocus::INTERACTABLE: {
+                    const auto interactable = getCurrentPage()->getCurrentInteractable();
+                    if (!interactable->onTouch(x, y)) {
+                        interactable->onTouchOutside();
+                    }
+                    break;
+                }
+                case RenderFocus::PAGE:
+                    getCurrentPage()->onTouch(x, y);
+                    break;
+                case RenderFocus::NONE:
+                default:
+                    return;
+            }
+            requestContextualRender();
+        }
+
     private:
         enum class RenderType {
             FULL,
             MENU_ONLY,
             INTERACTABLE_ONLY,
+            BACK, ///< FULL after popPage(), may show the kept frame of the page instead
         };
 
         struct RenderRequest {
             RenderType type;
+            uint32_t popped = 0; ///< BACK: serial of the page that was left, its kept frame is dropped
+        };
+
+        /** What the render callback draws for the current request. */
+        enum class RenderPass {
+            PAGE,          ///< run the render code of the page, menu or interactable
+            OVERLAY_DRAW,  ///< restore the saved screen in the window, then draw the overlay
+            OVERLAY_CLOSE, ///< restore the saved screen, then redraw the former owner if still focused
+            CACHED_FRAME,  ///< show the kept frame of the current page
+            MENU_REGIONS,  ///< redraw the menu cells and title a selection move changed, one window each
+            MENU_WIDGETS,  ///< redraw the menu widgets whose value changed on their own interval
         };
 
         static RenderManager &instance() {
@@ -192,6 +276,18 @@ namespace EPD {
         }
 
         Controller *epd{nullptr};
+        TouchTapDetector touchTapDetector{};
+        OverlayLayer overlay{};
+        RenderPass renderPass = RenderPass::PAGE;
+        static constexpr size_t MAX_MENU_REGIONS = 3;
+        RenderContext menuRegions[MAX_MENU_REGIONS];
+        size_t menuRegionCount = 0;
+
+        /** Frames of pages covered by another page, see popPage(). */
+        FrameCache frameCache{};
+        /** Serial of the page whose complete frame is on screen (no menu or overlay), and its frame version. */
+        uint32_t cleanPage = 0;
+        uint32_t cleanVersion = 0;
         static std::stack<std::shared_ptr<Page> > pageStack;
         static TaskHandle_t renderTaskHandle;
         static QueueHandle_t renderQueue;
@@ -201,18 +297,71 @@ namespace EPD {
         static constexpr size_t MAX_RENDER_REFRESH = 20;
         size_t executedRenders = 0;
 
-        static void renderPageCallback(const void *) {
+        /** Version a kept frame of the page is valid for; the theme changes every pixel. */
+        static uint32_t frameVersion(const Page &page) {
+            return page.getStateVersion() << 1 |
+                   (instance().epd->getDisplayTheme() == Controller::DisplayTheme::DARK ? 1 : 0);
+        }
+
+        static void requestBackRender(const uint32_t popped) {
+            if (!isInitialized()) {
+                Serial.println("RenderManager not initialized!");
+                return;
+            }
+            auto queue = instance().renderQueue;
+            const RenderRequest req{RenderType::BACK, popped};
+            if (xQueueSend(queue, &req, 0) != pdTRUE) {
+                Serial.println("Failed to send render request!");
+            }
+        }
+
+        static void renderPageCallback(const void *param) {
+            auto &display = instance().epd->getDisplay();
+
+            // Both clear their whole window, as GxEPD2 reuses its buffer for every window
+            if (instance().renderPass == RenderPass::MENU_REGIONS) {
+                renderMenuSelectionRegion(*instance().epd, *static_cast<const size_t *>(param));
+                return;
+            }
+            if (instance().renderPass == RenderPass::MENU_WIDGETS) {
+                renderMenuWidgetUpdates(*instance().epd, *static_cast<const RenderContext *>(param));
+                return;
+            }
+
+            if (instance().renderPass == RenderPass::CACHED_FRAME) {
+                const Page *page = getCurrentPage().get();
+                if (display.loadFrame([&](uint8_t *frame, const size_t size) {
+                    return instance().frameCache.restore(page->getSerial(), frameVersion(*page), frame, size);
+                })) {
+                    return;
+                }
+                // A kept frame that does not unpack is dropped and the page is rendered instead
+                instance().frameCache.erase(page->getSerial());
+                instance().renderPass = RenderPass::PAGE;
+            }
+
+            // Overlay passes put the saved screen back instead of running the page's render code
+            if (instance().renderPass != RenderPass::PAGE) {
+                instance().overlay.restore(display);
+                if (const auto currentInteractable = getCurrentPage()->getCurrentInteractable();
+                    currentInteractable != nullptr && instance().overlay.isOpenFor(currentInteractable)
+                ) {
+                    currentInteractable->executeRender(*instance().epd, currentInteractable->getLayoutSlot());
+                }
+                return;
+            }
+
             instance().epd->getDisplayTheme() == Controller::DisplayTheme::LIGHT
-                ? instance().epd->getDisplay().fillScreen(GxEPD_WHITE)
-                : instance().epd->getDisplay().fillScreen(GxEPD_BLACK);
+                ? display.fillScreen(GxEPD_WHITE)
+                : display.fillScreen(GxEPD_BLACK);
 
             if (!pageStack.empty()) {
-                //TODO: make this work as this prevents popover overlap, workaround is to render them later regardless of x,y pos
+                // Without a shadow frame there is no overlay layer, so this is the fallback for popovers
                 if (const auto currentInteractable = getCurrentPage()->getCurrentInteractable();
                     !getCurrentPage()->shouldRenderUnfocusedContent() && currentInteractable != nullptr &&
                     currentInteractable->getIsActive()
                 ) {
-                    currentInteractable->executeRender(*instance().epd, currentInteractable->lastRenderCTX);
+                    currentInteractable->executeRender(*instance().epd, currentInteractable->getLayoutSlot());
                 } else {
                     getCurrentPage()->executeRender(*instance().epd, RenderContext());
                 }
@@ -222,76 +371,221 @@ namespace EPD {
             }
         }
 
+        /** Rasterize and refresh the display for one queued request. */
+        static void executeRequest(RenderRequest req) {
+            const unsigned long startTime = millis();
+            auto &display = instance().epd->getDisplay();
+            // Holding the page keeps it alive should it be popped and released meanwhile
+            const std::shared_ptr<Page> currentPage = getCurrentPage();
+            const Page *page = currentPage.get();
+            const uint32_t serial = page != nullptr ? page->getSerial() : 0;
+
+            // An interactable with nothing to redraw drops the request before it counts
+            // as a render or touches the frame cache and the clean page.
+            Interactable *interactable = nullptr;
+            RenderContext paint, window;
+            if (req.type == RenderType::INTERACTABLE_ONLY) {
+                interactable = currentPage == nullptr ? nullptr : currentPage->getCurrentInteractable();
+                if (interactable == nullptr) {
+                    return;
+                }
+
+                // Lay out before rasterizing so size changes (e.g. an expanding dropdown) are part
+                // of the window, and keep the previous area covered so shrinking leaves no artifacts.
+                // If the area did not change, the element may narrow the window to what is dirty.
+                interactable->updateLayout(*instance().epd);
+                paint = interactable->getPaintBounds();
+                const RenderContext &lastPaint = interactable->lastPaintCTX;
+                const bool samePaintArea = paint.x == lastPaint.x && paint.y == lastPaint.y &&
+                                           paint.width == lastPaint.width &&
+                                           paint.height == lastPaint.height;
+                window = samePaintArea ? interactable->getDirtyBounds() : lastPaint.united(paint);
+                if (window.isEmpty()) {
+                    return;
+                }
+            }
+
+            instance().executedRenders++;
+            Serial.printf(
+                "Configuring window: executed renders: %d, max renders: %d\n",
+                instance().executedRenders,
+                MAX_RENDER_REFRESH
+            );
+
+            auto &overlay = instance().overlay;
+            auto &frameCache = instance().frameCache;
+            instance().renderPass = RenderPass::PAGE;
+
+            // Keep the frame of a page that is about to be covered by the menu or another page.
+            // After popPage() the frame on screen belongs to the page that was left.
+            if (req.type == RenderType::BACK) {
+                // The page that was left may be released already, only its serial is known
+                frameCache.erase(req.popped);
+                overlay.close();
+            } else if (instance().cleanPage != 0 &&
+                       (req.type == RenderType::MENU_ONLY || serial != instance().cleanPage)) {
+                frameCache.store(instance().cleanPage, instance().cleanVersion,
+                                 display.getShadowFrame(), Display::FRAME_SIZE);
+            }
+            if (serial != instance().cleanPage || req.type == RenderType::MENU_ONLY) {
+                instance().cleanPage = 0;
+            }
+
+            if (req.type == RenderType::BACK &&
+                (instance().executedRenders >= MAX_RENDER_REFRESH || isMenuActive() || page == nullptr ||
+                 !frameCache.contains(serial, frameVersion(*page)))) {
+                req.type = RenderType::FULL;
+            }
+            // Anything but the menu or the kept frame itself changes what the page shows
+            if (req.type != RenderType::MENU_ONLY && req.type != RenderType::BACK) {
+                frameCache.erase(serial);
+            }
+
+            if (req.type == RenderType::BACK) {
+                overlay.close();
+                display.setPartialWindow(0, 0, display.width(), display.height());
+                instance().renderPass = RenderPass::CACHED_FRAME;
+                Serial.print("Render type: BACK (cached frame), ");
+            } else if (req.type == RenderType::FULL &&
+                instance().executedRenders < MAX_RENDER_REFRESH &&
+                overlay.canRestore(page)) {
+                // The overlay closed on the same page: put back what was under it
+                const RenderContext bounds = overlay.getBounds(display);
+                display.setPartialWindow(bounds.x, bounds.y, bounds.width, bounds.height);
+                instance().renderPass = RenderPass::OVERLAY_CLOSE;
+                Serial.print("Render type: OVERLAY_CLOSE, ");
+            } else if (req.type == RenderType::FULL) {
+                // A full render rewrites the screen under any overlay
+                overlay.close();
+                if (instance().executedRenders >= MAX_RENDER_REFRESH) {
+                    display.setFullWindow();
+                    Serial.print("Render type: FULL, ");
+                    instance().executedRenders = 0;
+                } else {
+                    display.setPartialWindow(
+                        0,
+                        0,
+                        display.width(),
+                        display.height()
+                    );
+                    Serial.print("Render type: FULL (fast partial), ");
+                }
+            } else if (req.type == RenderType::MENU_ONLY) {
+                // The menu draws over the saved area, so it can no longer be restored as is
+                overlay.close();
+                // A selection move only changes two cells and the title line
+                instance().menuRegionCount = getMenuSelectionRegions(
+                    *instance().epd, instance().menuRegions, MAX_MENU_REGIONS);
+                if (instance().menuRegionCount > 0) {
+                    instance().renderPass = RenderPass::MENU_REGIONS;
+                    Serial.printf("Render type: MENU_ONLY (%u cell windows), ",
+                                  static_cast<unsigned>(instance().menuRegionCount));
+                } else {
+                    display.setPartialWindow(
+                        MenuConstants::X_POS,
+                        MenuConstants::getYPos(*instance().epd),
+                        MenuConstants::getWidth(*instance().epd),
+                        MenuConstants::HEIGHT
+                    );
+                    Serial.print("Render type: MENU_ONLY, ");
+                }
+            } else if (req.type == RenderType::INTERACTABLE_ONLY) {
+                // Save the screen under a newly opened overlay; its redraws then restore that
+                // instead of running the page's render code for the window.
+                if (!interactable->isOverlay()) {
+                    overlay.close();
+                } else if (!overlay.isOpenFor(interactable)) {
+                    overlay.open(display, interactable, page, paint);
+                }
+                if (overlay.isOpenFor(interactable)) {
+                    if (overlay.covers(display, window)) {
+                        instance().renderPass = RenderPass::OVERLAY_DRAW;
+                    } else {
+                        overlay.close();
+                    }
+                }
+
+                Serial.printf(
+                    "Partial window - x: %d, y: %d, width: %d, height: %d\n",
+                    window.x,
+                    window.y,
+                    window.width,
+                    window.height
+                );
+
+                display.setPartialWindow(
+                    window.x,
+                    window.y,
+                    window.width,
+                    window.height
+                );
+                // The page pass clears the window before the element draws
+                if (instance().renderPass == RenderPass::PAGE) {
+                    interactable->prepareRender(*instance().epd);
+                }
+                Serial.print("Render type: INTERACTABLE_ONLY, ");
+            }
+
+            const uint32_t allocationsBefore = AllocationCounter::get();
+            if (instance().renderPass == RenderPass::MENU_REGIONS) {
+                for (size_t i = 0; i < instance().menuRegionCount; i++) {
+                    const RenderContext &region = instance().menuRegions[i];
+                    display.setPartialWindow(region.x, region.y, region.width, region.height);
+                    display.drawPaged(renderPageCallback, &i);
+                }
+            } else {
+                display.drawPaged(renderPageCallback, nullptr);
+            }
+            const uint32_t renderAllocations = AllocationCounter::get() - allocationsBefore;
+            if (instance().renderPass == RenderPass::OVERLAY_CLOSE) {
+                overlay.close();
+            }
+            if (page != nullptr && !isMenuActive() && !overlay.isOpen() && display.hasShadowFrame()) {
+                instance().cleanPage = serial;
+                instance().cleanVersion = frameVersion(*page);
+            } else {
+                instance().cleanPage = 0;
+            }
+            const unsigned long endTime = millis();
+            Serial.printf("Time taken: %lu ms\n", endTime - startTime);
+            if (AllocationCounter::isEnabled()) {
+                Serial.printf("Heap allocations during render: %u\n", renderAllocations);
+            }
+        }
+
         [[noreturn]] static void renderTask(void *) {
             RenderRequest req{};
 
             while (true) {
-                if (xQueueReceive(renderQueue, &req, portMAX_DELAY) == pdTRUE) {
-                    const unsigned long startTime = millis();
-                    auto &display = instance().epd->getDisplay();
-
-                    instance().executedRenders++;
-                    Serial.printf(
-                        "Configuring window: executed renders: %d, max renders: %d\n",
-                        instance().executedRenders,
-                        MAX_RENDER_REFRESH
-                    );
+                // While the menu is open, wake up for widgets that refresh on their own
+                const uint32_t widgetDelay = getMenuWidgetRefreshDelay(millis());
+                const TickType_t wait = widgetDelay == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(widgetDelay);
 
-                    if (req.type == RenderType::FULL) {
-                        if (instance().executedRenders >= MAX_RENDER_REFRESH) {
-                            display.setFullWindow();
-                            Serial.print("Render type: FULL, ");
-                            instance().executedRenders = 0;
-                        } else {
-                            display.setPartialWindow(
-                                0,
-                                0,
-                                display.width(),
-                                display.height()
-                            );
-                            Serial.print("Render type: FULL (fast partial), ");
-                        }
-                    } else if (req.type == RenderType::MENU_ONLY) {
-                        display.setPartialWindow(
-                            MenuConstants::X_POS,
-                            MenuConstants::getYPos(*instance().epd),
-                            MenuConstants::getWidth(*instance().epd),
-                            MenuConstants::HEIGHT
-                        );
-                        Serial.print("Render type: MENU_ONLY, ");
-                    } else if (req.type == RenderType::INTERACTABLE_ONLY) {
-                        int x, y, width, height;
-                        const auto interactable = getCurrentPage()->getCurrentInteractable();
-
-                        if (interactable == nullptr) {
-                            continue;
-                        }
-
-                        interactable->getWindow(
-                            &x,
-                            &y,
-                            &width,
-                            &height
-                        );
-                        Serial.printf("Partial window - x: %d, y: %d, width: %d, height: %d\n", x, y, width, height);
-
-                        display.setPartialWindow(
-                            x,
-                            y,
-                            width,
-                            height
-                        );
-                        Serial.print("Render type: INTERACTABLE_ONLY, ");
+                if (xQueueReceive(renderQueue, &req, wait) != pdTRUE) {
+                    if (wait != portMAX_DELAY) {
+                        renderWidgetRefresh();
                     }
-
-                    display.drawPaged(renderPageCallback, nullptr);
-                    const unsigned long endTime = millis();
-                    Serial.printf("Time taken: %lu ms\n", endTime - startTime);
+                } else {
+                    executeRequest(req);
                 }
                 vTaskDelay(pdMS_TO_TICKS(10));
             }
         }
 
+        /** Redraw the menu widgets whose value changed, all in one partial window. */
+        static void renderWidgetRefresh() {
+            RenderContext window;
+            if (!collectMenuWidgetUpdates(*instance().epd, millis(), window)) return;
+
+            const unsigned long startTime = millis();
+            auto &display = instance().epd->getDisplay();
+            instance().executedRenders++;
+            instance().renderPass = RenderPass::MENU_WIDGETS;
+            display.setPartialWindow(window.x, window.y, window.width, window.height);
+            display.drawPaged(renderPageCallback, &window);
+            Serial.printf("Render type: MENU_WIDGETS, time taken: %lu ms\n", millis() - startTime);
+        }
+
         static bool isInitialized() {
             return instance().epd != nullptr && instance().renderQueue != nullptr;
         }
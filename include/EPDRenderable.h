@@ -4,8 +4,16 @@
  * Lightweight rendering base types for the GXUI framework.
  *
  * - EPD::RenderContext captures a rectangular drawing area for a widget.
+ * - EPD::Size is the desired size reported by the measure pass.
  * - EPD::Renderable is the abstract base that provides the render pipeline.
+ *
+ * Layout runs in two phases before drawing: measure() asks an element for
+ * its desired size and arrange() assigns the final rectangle. Both results
+ * are cached per element and only recomputed after invalidateLayout() or
+ * when the constraints handed down by the parent change.
  */
+#include <algorithm>
+
 namespace EPD {
     class Controller;
 
@@ -27,6 +35,40 @@ namespace EPD {
             const int height = 0
         ) : x(x), y(y), width(width), height(height) {
         }
+
+        [[nodiscard]] bool isEmpty() const {
+            return width <= 0 || height <= 0;
+        }
+
+        [[nodiscard]] bool contains(const int px, const int py) const {
+            return px >= x && py >= y && px < x + width && py < y + height;
+        }
+
+        /** Smallest rectangle covering both this and the other rectangle. */
+        [[nodiscard]] RenderContext united(const RenderContext &other) const {
+            if (isEmpty()) return RenderContext(other.x, other.y, other.width, other.height);
+            if (other.isEmpty()) return RenderContext(x, y, width, height);
+
+            const int left = std::min(x, other.x);
+            const int top = std::min(y, other.y);
+            const int right = std::max(x + width, other.x + other.width);
+            const int bottom = std::max(y + height, other.y + other.height);
+            return RenderContext(left, top, right - left, bottom - top);
+        }
+    };
+
+    /** Desired size of an element as reported by the measure pass. */
+    struct Size {
+        int width{0};
+        int height{0};
+
+        bool operator==(const Size &other) const {
+            return width == other.width && height == other.height;
+        }
+
+        bool operator!=(const Size &other) const {
+            return !(*this == other);
+        }
     };
 
     /**
@@ -35,20 +77,177 @@ namespace EPD {
      * render context for later queries.
      */
     class Renderable {
+        /** Cached measure result and the constraints it was computed for. */
+        Size measuredSize{};
+        Size measureConstraints{};
+        bool layoutValid = false;
+
+        /**
+         * Unconstrained measure result, cached on its own. A stretching container
+         * asks for it to find the cross size it then measures with, and that
+         * second measure must not evict it.
+         */
+        Size naturalSize{};
+        bool naturalValid = false;
+
+        /** Slot last offered by the parent, kept to re-run layout without it. */
+        RenderContext layoutSlot = RenderContext();
+
+        /** Container that positions this element; notified on invalidation. */
+        Renderable *layoutParent = nullptr;
+
     protected:
         /** Perform the actual drawing for the given context. */
         virtual void renderContent(Controller &epd, const RenderContext &ctx) = 0;
 
+        /**
+         * Compute the desired size for the available space. A zero dimension
+         * means unconstrained. The default keeps the available space, which
+         * suits elements that are sized by their parent.
+         */
+        virtual Size onMeasure(Controller &epd, const Size &available) {
+            return available;
+        }
+
+        /**
+         * Assign the final rectangle inside the slot offered by the parent.
+         * Grid aligned elements snap position and size to LAYOUT_GRID so their
+         * partial windows stay byte aligned on the panel.
+         */
+        virtual RenderContext onArrange(const RenderContext &slot, const Size &size) {
+            if (!isGridAligned()) {
+                return RenderContext(slot.x, slot.y, size.width, size.height);
+            }
+            return RenderContext(
+                snapToGrid(slot.x),
+                snapToGrid(slot.y),
+                snapToGrid(size.width),
+                snapToGrid(size.height)
+            );
+        }
+
+        /** Whether arrange should snap this element to LAYOUT_GRID. */
+        [[nodiscard]] virtual bool isGridAligned() const {
+            return false;
+        }
+
     public:
+        /** Pixel grid used for partial-window friendly placement. */
+        static constexpr int LAYOUT_GRID = 8;
+
+        /** Round a coordinate or length up to the next LAYOUT_GRID multiple. */
+        static constexpr int snapToGrid(const int value) {
+            return (value + LAYOUT_GRID - 1) & ~(LAYOUT_GRID - 1);
+        }
+
         /** Last render window, useful for hit testing or incremental redraws. */
         mutable RenderContext lastRenderCTX = RenderContext();
 
+        /** Area covered by the last render, see getPaintBounds(). */
+        mutable RenderContext lastPaintCTX = RenderContext();
+
         virtual ~Renderable() = default;
 
-        /** Template method to render and store the context used. */
+        /**
+         * Desired size for the given constraints. Cached until the content
+         * changes (invalidateLayout) or different constraints are passed; the
+         * unconstrained size is kept besides the last constrained one.
+         */
+        Size measure(Controller &epd, const Size &available = Size()) {
+            if (available == Size()) {
+                if (!naturalValid) {
+                    naturalSize = onMeasure(epd, available);
+                    naturalValid = true;
+                }
+                return naturalSize;
+            }
+            if (!layoutValid || available != measureConstraints) {
+                measuredSize = onMeasure(epd, available);
+                measureConstraints = available;
+                layoutValid = true;
+            }
+            return measuredSize;
+        }
+
+        /** Assign the final rectangle for a measured size inside a slot. */
+        const RenderContext &arrange(const RenderContext &slot, const Size &size) {
+            layoutSlot = RenderContext(slot.x, slot.y, slot.width, slot.height);
+            lastRenderCTX = onArrange(slot, size);
+            return lastRenderCTX;
+        }
+
+        /** Measure and arrange in one step for the given parent slot. */
+        const RenderContext &layout(Controller &epd, const RenderContext &slot) {
+            return arrange(slot, measure(epd, Size{slot.width, slot.height}));
+        }
+
+        /**
+         * Re-run layout against the last slot so the window is known before
+         * the next rasterization, e.g. when only this element gets redrawn.
+         */
+        const RenderContext &updateLayout(Controller &epd) {
+            return layout(epd, layoutSlot);
+        }
+
+        /**
+         * Mark the cached measure result stale after a size-affecting change.
+         * The owning container is invalidated as well so it can re-place its
+         * children on the next layout pass.
+         */
+        void invalidateLayout() {
+            layoutValid = false;
+            naturalValid = false;
+            if (layoutParent != nullptr) {
+                layoutParent->invalidateLayout();
+            }
+        }
+
+        void setLayoutParent(Renderable *parent) {
+            layoutParent = parent;
+        }
+
+        [[nodiscard]] Renderable *getLayoutParent() const {
+            return layoutParent;
+        }
+
+        [[nodiscard]] bool isLayoutValid() const {
+            return layoutValid || naturalValid;
+        }
+
+        /**
+         * Area this element draws into. Usually the arranged rect, but elements
+         * that overflow their layout slot without reflowing siblings (e.g. an
+         * expanded dropdown list) report the larger area here.
+         */
+        [[nodiscard]] virtual RenderContext getPaintBounds() const {
+            return RenderContext(lastRenderCTX.x, lastRenderCTX.y, lastRenderCTX.width, lastRenderCTX.height);
+        }
+
+        /**
+         * Part of the paint bounds that changed since the last render. Elements
+         * that can redraw a sub-area (e.g. a list moving its selection by one
+         * row) narrow this so only that window gets refreshed.
+         */
+        [[nodiscard]] virtual RenderContext getDirtyBounds() const {
+            return getPaintBounds();
+        }
+
+        /** Slot last offered by the parent, as opposed to the arranged rect. */
+        [[nodiscard]] const RenderContext &getLayoutSlot() const {
+            return layoutSlot;
+        }
+
+        /** Template method to lay out, render and store the context used. */
         virtual void executeRender(Controller &epd, const RenderContext &ctx) {
+            const RenderContext &rect = layout(epd, ctx);
+            ctx.x = rect.x;
+            ctx.y = rect.y;
+            ctx.width = rect.width;
+            ctx.height = rect.height;
+
             renderContent(epd, ctx);
             lastRenderCTX = ctx;
+            lastPaintCTX = getPaintBounds();
         }
 
         /** Retrieve the most recent window used to draw this element. */
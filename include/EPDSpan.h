@@ -0,0 +1,55 @@
+#ifndef EPDSPAN_H
+#define EPDSPAN_H
+
+/**
+ * @file EPDSpan.h
+ * Non-owning array view used for option tables.
+ *
+ * EPD::Span is a minimal stand-in for C++20 std::span. Widgets that show a
+ * fixed set of choices keep a Span instead of copying the choices, so a
+ * table can live in flash (a static const array) or in a container owned by
+ * the page without a second heap copy. The viewed storage must outlive the
+ * widget; binding a temporary vector is rejected at compile time.
+ */
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace EPD {
+    template<typename T>
+    class Span {
+        T *items = nullptr;
+        size_t count = 0;
+
+    public:
+        constexpr Span() = default;
+
+        constexpr Span(T *items, const size_t count) : items(items), count(count) {
+        }
+
+        /** View a static table, e.g. `static const char *const OPTIONS[] = {...};` */
+        template<size_t N>
+        constexpr Span(T (&array)[N]) : items(array), count(N) {
+        }
+
+        /** View a container owned elsewhere, e.g. a member vector of the page. */
+        template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> > >
+        Span(const std::vector<U> &vector) : items(vector.data()), count(vector.size()) {
+        }
+
+        /** A temporary vector would dangle as soon as the widget is constructed. */
+        template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> > >
+        Span(std::vector<U> &&vector) = delete;
+
+        [[nodiscard]] constexpr size_t size() const { return count; }
+        [[nodiscard]] constexpr bool empty() const { return count == 0; }
+        [[nodiscard]] constexpr T *data() const { return items; }
+
+        constexpr T &operator[](const size_t index) const { return items[index]; }
+
+        constexpr T *begin() const { return items; }
+        constexpr T *end() const { return items + count; }
+    };
+}
+#endif //EPDSPAN_H
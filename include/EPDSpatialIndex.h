@@ -0,0 +1,291 @@
+#ifndef EPDSPATIALINDEX_H
+#define EPDSPATIALINDEX_H
+
+/**
+ * @file EPDSpatialIndex.h
+ * Uniform-grid spatial index over widget rectangles.
+ *
+ * Provides:
+ *  - EPD::FocusDirection: the four navigation directions
+ *  - EPD::SpatialIndex: rectangles bucketed into fixed-size grid cells
+ *
+ * The index is built from a list of rectangles (usually the lastRenderCTX of
+ * a page's interactables) and answers two questions cheaply: which entry is
+ * the nearest neighbour in a direction (focus navigation), and which entry
+ * is on top at a point (hit testing). Buckets are stored as one flat array
+ * with per-cell offsets, so a rebuild performs two allocations at most and
+ * queries allocate nothing. Rebuild only when the layout changes.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "EPDRenderable.h"
+
+namespace EPD {
+    enum class FocusDirection {
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT
+    };
+
+    class SpatialIndex {
+    public:
+        static constexpr int DEFAULT_CELL_SIZE = 64;
+
+        void clear() {
+            rects.clear();
+            cellOffsets.clear();
+            cellEntries.clear();
+            columns = 0;
+            rows = 0;
+        }
+
+        /**
+         * Rebuild the index. Entry ids are the positions in rects; empty
+         * rectangles are kept as ids but never returned by queries.
+         */
+        void build(const std::vector<RenderContext> &source, const int cell = DEFAULT_CELL_SIZE) {
+            clear();
+            cellSize = std::max(8, cell);
+            rects.reserve(source.size());
+            for (const auto &rect: source) {
+                rects.emplace_back(rect.x, rect.y, rect.width, rect.height);
+            }
+            visitStamps.assign(rects.size(), 0);
+            if (rects.empty()) return;
+
+            int right = std::numeric_limits<int>::min();
+            int bottom = std::numeric_limits<int>::min();
+            originX = std::numeric_limits<int>::max();
+            originY = std::numeric_limits<int>::max();
+            for (const auto &rect: rects) {
+                if (rect.isEmpty()) continue;
+                originX = std::min(originX, rect.x);
+                originY = std::min(originY, rect.y);
+                right = std::max(right, rect.x + rect.width);
+                bottom = std::max(bottom, rect.y + rect.height);
+            }
+            if (right == std::numeric_limits<int>::min()) return;
+
+            columns = (right - originX + cellSize - 1) / cellSize;
+            rows = (bottom - originY + cellSize - 1) / cellSize;
+
+            // Counting pass, then prefix sums, then fill: a CSR layout of the buckets
+            cellOffsets.assign(static_cast<size_t>(columns) * rows + 1, 0);
+            for (const auto &rect: rects) {
+                forEachCell(rect, [&](const size_t cellIndex) { cellOffsets[cellIndex + 1]++; });
+            }
+            for (size_t i = 1; i < cellOffsets.size(); i++) {
+                cellOffsets[i] += cellOffsets[i - 1];
+            }
+
+            cellEntries.assign(cellOffsets.back(), 0);
+            std::vector<uint32_t> fill(cellOffsets.begin(), cellOffsets.end() - 1);
+            for (size_t id = 0; id < rects.size(); id++) {
+                forEachCell(rects[id], [&](const size_t cellIndex) {
+                    cellEntries[fill[cellIndex]++] = static_cast<uint16_t>(id);
+                });
+            }
+        }
+
+        [[nodiscard]] size_t size() const {
+            return rects.size();
+        }
+
+        [[nodiscard]] const RenderContext &getRect(const size_t id) const {
+            return rects[id];
+        }
+
+        /**
+         * Visit every entry whose rectangle intersects area, each exactly once.
+         * The visitor returns false to stop early.
+         */
+        template<typename Visitor>
+        void query(const RenderContext &area, Visitor &&visit) const {
+            if (columns == 0 || area.isEmpty()) return;
+            const uint32_t stamp = nextStamp();
+
+            const int c0 = std::max(0, (area.x - originX) / cellSize);
+            const int r0 = std::max(0, (area.y - originY) / cellSize);
+            const int c1 = std::min(columns - 1, (area.x + area.width - 1 - originX) / cellSize);
+            const int r1 = std::min(rows - 1, (area.y + area.height - 1 - originY) / cellSize);
+
+            for (int r = r0; r <= r1; r++) {
+                for (int c = c0; c <= c1; c++) {
+                    const size_t cellIndex = static_cast<size_t>(r) * columns + c;
+                    for (uint32_t i = cellOffsets[cellIndex]; i < cellOffsets[cellIndex + 1]; i++) {
+                        const uint16_t id = cellEntries[i];
+                        if (visitStamps[id] == stamp) continue;
+                        visitStamps[id] = stamp;
+                        if (intersects(rects[id], area) && !visit(static_cast<size_t>(id))) return;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Topmost entry containing the point, or -1. Entries added later are
+         * considered on top, matching the order widgets are drawn in.
+         */
+        [[nodiscard]] int hitTest(const int x, const int y) const {
+            int hit = -1;
+            query(RenderContext(x, y, 1, 1), [&](const size_t id) {
+                hit = std::max(hit, static_cast<int>(id));
+                return true;
+            });
+            return hit;
+        }
+
+        /**
+         * Nearest entry in the given direction from entry `from`, or -1.
+         *
+         * Both edges of a candidate must lie further in the direction than the
+         * matching edges of the current rectangle. The score is the edge gap along the direction plus twice the gap on the
+         * perpendicular axis, so widgets in the same row/column win over
+         * closer diagonal ones. Cells are scanned in bands moving away from
+         * the current rectangle and the scan stops once no closer candidate
+         * can exist.
+         */
+        [[nodiscard]] int nearestInDirection(const size_t from, const FocusDirection direction) const {
+            if (from >= rects.size() || columns == 0 || rects[from].isEmpty()) return -1;
+
+            const RenderContext &current = rects[from];
+            const bool horizontal = direction == FocusDirection::LEFT || direction == FocusDirection::RIGHT;
+            const bool forward = direction == FocusDirection::RIGHT || direction == FocusDirection::DOWN;
+
+            const int bandCount = horizontal ? columns : rows;
+            const int currentStart = horizontal ? current.x : current.y;
+            const int currentEnd = currentStart + (horizontal ? current.width : current.height);
+            const int origin = horizontal ? originX : originY;
+
+            int band = ((forward ? currentEnd - 1 : currentStart) - origin) / cellSize;
+            band = std::max(0, std::min(bandCount - 1, band));
+
+            int best = -1;
+            long bestScore = std::numeric_limits<long>::max();
+            long bestOffset = std::numeric_limits<long>::max();
+
+            for (; band >= 0 && band < bandCount; band += forward ? 1 : -1) {
+                // Lower bound of the primary distance for anything starting in this band
+                const int bandEdge = origin + band * cellSize + (forward ? 0 : cellSize);
+                const long bound = forward ? bandEdge - currentEnd : currentStart - bandEdge;
+                if (best >= 0 && bound > bestScore) break;
+
+                const RenderContext bandArea = horizontal
+                                                   ? RenderContext(origin + band * cellSize, originY, cellSize,
+                                                                   rows * cellSize)
+                                                   : RenderContext(originX, origin + band * cellSize,
+                                                                   columns * cellSize, cellSize);
+
+                query(bandArea, [&](const size_t id) {
+                    if (id == from) return true;
+                    long score, offset;
+                    if (!scoreCandidate(current, rects[id], direction, score, offset)) return true;
+                    if (score < bestScore || (score == bestScore && offset < bestOffset)) {
+                        best = static_cast<int>(id);
+                        bestScore = score;
+                        bestOffset = offset;
+                    }
+                    return true;
+                });
+            }
+            return best;
+        }
+
+    private:
+        std::vector<RenderContext> rects{};
+        std::vector<uint32_t> cellOffsets{};
+        std::vector<uint16_t> cellEntries{};
+        mutable std::vector<uint32_t> visitStamps{};
+        mutable uint32_t stampCounter = 0;
+
+        int cellSize = DEFAULT_CELL_SIZE;
+        int originX = 0;
+        int originY = 0;
+        int columns = 0;
+        int rows = 0;
+
+        uint32_t nextStamp() const {
+            if (++stampCounter == 0) {
+                std::fill(visitStamps.begin(), visitStamps.end(), 0);
+                stampCounter = 1;
+            }
+            return stampCounter;
+        }
+
+        static bool intersects(const RenderContext &a, const RenderContext &b) {
+            return !a.isEmpty() &&
+                   a.x < b.x + b.width && b.x < a.x + a.width &&
+                   a.y < b.y + b.height && b.y < a.y + a.height;
+        }
+
+        template<typename Fn>
+        void forEachCell(const RenderContext &rect, Fn &&fn) const {
+            if (rect.isEmpty()) return;
+            const int c0 = (rect.x - originX) / cellSize;
+            const int r0 = (rect.y - originY) / cellSize;
+            const int c1 = (rect.x + rect.width - 1 - originX) / cellSize;
+            const int r1 = (rect.y + rect.height - 1 - originY) / cellSize;
+            for (int r = r0; r <= r1; r++) {
+                for (int c = c0; c <= c1; c++) {
+                    fn(static_cast<size_t>(r) * columns + c);
+                }
+            }
+        }
+
+        /** Distance between [a0, a1) and [b0, b1), zero when they overlap. */
+        static long gap(const int a0, const int a1, const int b0, const int b1) {
+            if (b0 >= a1) return b0 - a1;
+            if (a0 >= b1) return a0 - b1;
+            return 0;
+        }
+
+        static bool scoreCandidate(
+            const RenderContext &from,
+            const RenderContext &to,
+            const FocusDirection direction,
+            long &score,
+            long &offset
+        ) {
+            const int fromCx = from.x + from.width / 2;
+            const int fromCy = from.y + from.height / 2;
+            const int toCx = to.x + to.width / 2;
+            const int toCy = to.y + to.height / 2;
+
+            long primary, perpendicular;
+            switch (direction) {
+                case FocusDirection::RIGHT:
+                    if (to.x <= from.x || to.x + to.width <= from.x + from.width) return false;
+                    primary = std::max(0, to.x - (from.x + from.width));
+                    perpendicular = gap(from.y, from.y + from.height, to.y, to.y + to.height);
+                    offset = std::abs(toCy - fromCy);
+                    break;
+                case FocusDirection::LEFT:
+                    if (to.x >= from.x || to.x + to.width >= from.x + from.width) return false;
+                    primary = std::max(0, from.x - (to.x + to.width));
+                    perpendicular = gap(from.y, from.y + from.height, to.y, to.y + to.height);
+                    offset = std::abs(toCy - fromCy);
+                    break;
+                case FocusDirection::DOWN:
+                    if (to.y <= from.y || to.y + to.height <= from.y + from.height) return false;
+                    primary = std::max(0, to.y - (from.y + from.height));
+                    perpendicular = gap(from.x, from.x + from.width, to.x, to.x + to.width);
+                    offset = std::abs(toCx - fromCx);
+                    break;
+                case FocusDirection::UP:
+                default:
+                    if (to.y >= from.y || to.y + to.height >= from.y + from.height) return false;
+                    primary = std::max(0, from.y - (to.y + to.height));
+                    perpendicular = gap(from.x, from.x + from.width, to.x, to.x + to.width);
+                    offset = std::abs(toCx - fromCx);
+                    break;
+            }
+            score = primary + perpendicular * 2;
+            return true;
+        }
+    };
+}
+#endif //EPDSPATIALINDEX_H
@@ -0,0 +1,145 @@
+#ifndef EPDSTRING_H
+#define EPDSTRING_H
+
+/**
+ * @file EPDString.h
+ * Non-allocating text types for labels and titles.
+ *
+ *  - EPD::StringRef refers to null-terminated text owned elsewhere, e.g. a
+ *    string literal in flash or a FixedString, like std::string_view.
+ *  - EPD::FixedString<N> keeps up to N characters inline and truncates
+ *    longer text, so copying or building it never touches the heap.
+ *  - EPD::Label is the FixedString widgets store their labels in. Define
+ *    GXUI_LABEL_CAPACITY before including GXUI to change its length.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifndef GXUI_LABEL_CAPACITY
+#define GXUI_LABEL_CAPACITY 31
+#endif
+
+namespace EPD {
+    class StringRef {
+        const char *text = "";
+        size_t size = 0;
+
+    public:
+        constexpr StringRef() = default;
+
+        StringRef(const char *text) : text(text != nullptr ? text : ""), size(text != nullptr ? strlen(text) : 0) {
+        }
+
+        constexpr StringRef(const char *text, const size_t size) : text(text), size(size) {
+        }
+
+        StringRef(const String &text) : text(text.c_str()), size(text.length()) {
+        }
+
+        /** A temporary String would be gone before the reference is used. */
+        StringRef(String &&) = delete;
+
+        /** Null-terminated, valid as long as the referenced text. */
+        [[nodiscard]] constexpr const char *c_str() const {
+            return text;
+        }
+
+        [[nodiscard]] constexpr size_t length() const {
+            return size;
+        }
+
+        [[nodiscard]] constexpr bool isEmpty() const {
+            return size == 0;
+        }
+
+        bool operator==(const StringRef &other) const {
+            return size == other.size && memcmp(text, other.text, size) == 0;
+        }
+
+        bool operator!=(const StringRef &other) const {
+            return !(*this == other);
+        }
+    };
+
+    template<size_t Capacity>
+    class FixedString {
+        char buffer[Capacity + 1] = {};
+        size_t size = 0;
+
+    public:
+        static constexpr size_t CAPACITY = Capacity;
+
+        FixedString() = default;
+
+        FixedString(const StringRef text) {
+            append(text);
+        }
+
+        FixedString(const char *text) : FixedString(StringRef(text)) {
+        }
+
+        FixedString(const String &text) : FixedString(StringRef(text)) {
+        }
+
+        FixedString &operator=(const StringRef text) {
+            clear();
+            return append(text);
+        }
+
+        /** Append as much of text as fits. */
+        FixedString &append(const StringRef text) {
+            const size_t count = std::min(text.length(), Capacity - size);
+            memcpy(buffer + size, text.c_str(), count);
+            size += count;
+            buffer[size] = '\0';
+            return *this;
+        }
+
+        FixedString &append(const char c) {
+            if (size < Capacity) {
+                buffer[size++] = c;
+                buffer[size] = '\0';
+            }
+            return *this;
+        }
+
+        void clear() {
+            size = 0;
+            buffer[0] = '\0';
+        }
+
+        /** Keep the first length characters. */
+        void truncate(const size_t length) {
+            if (length < size) {
+                size = length;
+                buffer[size] = '\0';
+            }
+        }
+
+        [[nodiscard]] const char *c_str() const {
+            return buffer;
+        }
+
+        [[nodiscard]] size_t length() const {
+            return size;
+        }
+
+        [[nodiscard]] bool isEmpty() const {
+            return size == 0;
+        }
+
+        [[nodiscard]] bool isFull() const {
+            return size == Capacity;
+        }
+
+        operator StringRef() const {
+            return StringRef(buffer, size);
+        }
+    };
+
+    using Label = FixedString<GXUI_LABEL_CAPACITY>;
+}
+#endif //EPDSTRING_H
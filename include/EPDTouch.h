@@ -0,0 +1,125 @@
+#ifndef EPDTOUCH_H
+#define EPDTOUCH_H
+
+/**
+ * @file EPDTouch.h
+ * Touch input primitives for GXUI.
+ *
+ * Provides:
+ *  - EPD::TouchEvent: a raw touch sample in panel coordinates
+ *  - EPD::TouchTransform: maps panel coordinates to the rotated display
+ *  - EPD::TouchTapDetector: turns a down/move/up stream into taps
+ *
+ * Touch controllers report coordinates in the native orientation of the
+ * panel, while widgets are laid out after display.setRotation(). The
+ * transform undoes the rotation the same way Adafruit_GFX applies it, so a
+ * tap lands on the widget drawn under the finger. Routing of taps to the
+ * menu, modal and page layers is done by RenderManager::onTouchStatic.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace EPD {
+    enum class TouchPhase {
+        DOWN,
+        MOVE,
+        UP
+    };
+
+    /** One sample from the touch controller, in native panel coordinates. */
+    struct TouchEvent {
+        TouchPhase phase{TouchPhase::DOWN};
+        int x{0};
+        int y{0};
+    };
+
+    /** Mapping from native panel coordinates to logical (rotated) coordinates. */
+    struct TouchTransform {
+        uint8_t rotation{0};   ///< display rotation, 0..3
+        int panelWidth{0};     ///< native panel width (rotation 0)
+        int panelHeight{0};    ///< native panel height (rotation 0)
+
+        /** Derive the transform from the current rotation of a GFX display. */
+        template<typename Display>
+        static TouchTransform forDisplay(Display &display) {
+            const uint8_t rotation = display.getRotation() & 3;
+            const bool swapped = rotation & 1;
+            return TouchTransform{
+                rotation,
+                swapped ? display.height() : display.width(),
+                swapped ? display.width() : display.height()
+            };
+        }
+
+        /** Inverse of the rotation Adafruit_GFX applies in drawPixel. */
+        void toLogical(const int panelX, const int panelY, int &x, int &y) const {
+            switch (rotation & 3) {
+                case 1:
+                    x = panelY;
+                    y = panelWidth - 1 - panelX;
+                    break;
+                case 2:
+                    x = panelWidth - 1 - panelX;
+                    y = panelHeight - 1 - panelY;
+                    break;
+                case 3:
+                    x = panelHeight - 1 - panelY;
+                    y = panelX;
+                    break;
+                case 0:
+                default:
+                    x = panelX;
+                    y = panelY;
+                    break;
+            }
+        }
+    };
+
+    /**
+     * Tap recognition on a stream of touch events. A tap is a down followed
+     * by an up that stayed within TAP_SLOP pixels; anything further is a drag
+     * and is dropped. The detector holds no timing state, which keeps it
+     * deterministic when fed synthetic streams on host.
+     */
+    class TouchTapDetector {
+        bool tracking = false;
+        int downX = 0;
+        int downY = 0;
+
+    public:
+        static constexpr int TAP_SLOP = 16;
+
+        /**
+         * Feed one event in logical coordinates.
+         * @return true if the event completed a tap, reported at the down position
+         */
+        bool feed(const TouchPhase phase, const int x, const int y, int &tapX, int &tapY) {
+            switch (phase) {
+                case TouchPhase::DOWN:
+                    tracking = true;
+                    downX = x;
+                    downY = y;
+                    return false;
+                case TouchPhase::MOVE:
+                    if (tracking && (std::abs(x - downX) > TAP_SLOP || std::abs(y - downY) > TAP_SLOP)) {
+                        tracking = false;
+                    }
+                    return false;
+                case TouchPhase::UP:
+                default:
+                    if (!tracking) return false;
+                    tracking = false;
+                    if (std::abs(x - downX) > TAP_SLOP || std::abs(y - downY) > TAP_SLOP) return false;
+                    tapX = downX;
+                    tapY = downY;
+                    return true;
+            }
+        }
+
+        void reset() {
+            tracking = false;
+        }
+    };
+}
+#endif //EPDTOUCH_H
@@ -0,0 +1,116 @@
+/**
+ * @file ListScrollTest.cpp
+ * Host test for the rows EPD::InteractableList keeps when it scrolls.
+ *
+ * The list is driven with the same steps RenderManager takes for an
+ * INTERACTABLE_ONLY request: lay out, narrow the window to the dirty rows,
+ * let the element prepare, clear the window and render. After every scroll
+ * the shadow frame has to match a list that was drawn in one go at the same
+ * position, so rows that were moved instead of redrawn are checked too.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "EPDInteractable.h"
+
+using namespace EPD;
+
+namespace {
+    int failures = 0;
+
+    void check(const bool condition, const char *what) {
+        if (condition) return;
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+
+    const RenderContext SLOT(40, 80, 240, 200);
+
+    void provideRow(const size_t index, ListRow &row) {
+        row.text.append("Entry ").append(static_cast<int>(index));
+    }
+
+    void clearScreen(Display &display) {
+        display.setPartialWindow(0, 0, display.width(), display.height());
+        display.fillScreen(GxEPD_WHITE);
+    }
+
+    /** Redraw what changed, the way RenderManager::executeRequest does for the focused element. */
+    void renderChanges(Controller &epd, InteractableList &list) {
+        auto &display = epd.getDisplay();
+        list.updateLayout(epd);
+        const RenderContext window = list.getDirtyBounds();
+        if (window.isEmpty()) return;
+
+        display.setPartialWindow(window.x, window.y, window.width, window.height);
+        list.prepareRender(epd);
+        display.fillScreen(GxEPD_WHITE);
+        list.executeRender(epd, list.getLayoutSlot());
+    }
+
+    std::vector<uint8_t> shadow(Display &display) {
+        const uint8_t *frame = display.getShadowFrame();
+        return std::vector<uint8_t>(frame, frame + Display::FRAME_SIZE);
+    }
+
+    /** The frame of a list drawn from scratch after the same key presses. */
+    std::vector<uint8_t> expected(Controller &epd, const size_t items, const std::vector<int> &presses) {
+        InteractableList list("expected", items, provideRow);
+        list.onAction();
+        for (const int press: presses) {
+            press > 0 ? list.onActionDown() : list.onActionUp();
+        }
+        clearScreen(epd.getDisplay());
+        list.executeRender(epd, SLOT);
+        return shadow(epd.getDisplay());
+    }
+
+    void testScroll(Controller &epd, const size_t items, const std::vector<int> &presses, const char *what) {
+        auto &display = epd.getDisplay();
+        InteractableList list("list", items, provideRow);
+        clearScreen(display);
+        list.executeRender(epd, SLOT);
+
+        std::vector<int> done;
+        list.onAction();
+        renderChanges(epd, list);
+        for (const int press: presses) {
+            press > 0 ? list.onActionDown() : list.onActionUp();
+            renderChanges(epd, list);
+            done.push_back(press);
+
+            const std::vector<uint8_t> actual = shadow(display);
+            if (actual != expected(epd, items, done)) {
+                std::printf("  after %zu presses, selected %zu\n", done.size(), list.getSelectedIndex());
+                check(false, what);
+                return;
+            }
+            // expected() drew over the screen, put the list under test back
+            display.setPartialWindow(0, 0, display.width(), display.height());
+            display.loadFrame([&](uint8_t *frame, const size_t size) {
+                std::memcpy(frame, actual.data(), size);
+                return true;
+            });
+        }
+    }
+}
+
+int main() {
+    Controller &epd = Controller::getInstance();
+    Preferences preferences;
+    epd.init(&preferences);
+    check(epd.getDisplay().enableShadowFrame(), "shadow frame allocated");
+
+    // Seven rows in a five row window: paging down from row 4 is clamped and keeps three rows
+    testScroll(epd, 7, {1, 1, 1, 1, 1, 1}, "clamped page down keeps the moved rows");
+    testScroll(epd, 7, {1, 1, 1, 1, 1, -1, -1, -1, -1, -1}, "clamped page up keeps the moved rows");
+    // Paging by a whole window keeps nothing
+    testScroll(epd, 20, {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, "page down without kept rows");
+
+    if (failures == 0) {
+        std::printf("list scroll: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file TouchTest.cpp
+ * Host test for EPD::TouchTransform and EPD::TouchTapDetector.
+ *
+ * EPDTouch.h has no Arduino dependencies, so it is compiled for the host and
+ * run by ctest. Every rotation is checked against the mapping GxEPD2 applies
+ * in drawPixel, then tap, drag and bounce streams in panel coordinates are fed
+ * through the transform and the detector the way RenderManager does.
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "EPDTouch.h"
+
+using namespace EPD;
+
+namespace {
+    constexpr int PANEL_WIDTH = 800;
+    constexpr int PANEL_HEIGHT = 480;
+
+    int failures = 0;
+
+    void check(const bool condition, const char *what, const int rotation) {
+        if (condition) return;
+        std::printf("FAIL rotation %d: %s\n", rotation, what);
+        failures++;
+    }
+
+    /** Just enough of a GFX display for TouchTransform::forDisplay. */
+    struct FakeDisplay {
+        uint8_t rotation;
+
+        [[nodiscard]] uint8_t getRotation() const { return rotation; }
+        [[nodiscard]] int width() const { return rotation & 1 ? PANEL_HEIGHT : PANEL_WIDTH; }
+        [[nodiscard]] int height() const { return rotation & 1 ? PANEL_WIDTH : PANEL_HEIGHT; }
+    };
+
+    /** Logical to panel pixel, as GxEPD2 maps it in drawPixel. */
+    void toPanel(const int rotation, const int x, const int y, int &panelX, int &panelY) {
+        switch (rotation) {
+            case 1:
+                panelX = PANEL_WIDTH - 1 - y;
+                panelY = x;
+                break;
+            case 2:
+                panelX = PANEL_WIDTH - 1 - x;
+                panelY = PANEL_HEIGHT - 1 - y;
+                break;
+            case 3:
+                panelX = y;
+                panelY = PANEL_HEIGHT - 1 - x;
+                break;
+            default:
+                panelX = x;
+                panelY = y;
+                break;
+        }
+    }
+
+    struct Tap {
+        int x;
+        int y;
+    };
+
+    /** A touch at a logical point, converted to the panel sample the controller reports. */
+    TouchEvent touch(const int rotation, const TouchPhase phase, const int x, const int y) {
+        TouchEvent event{phase};
+        toPanel(rotation, x, y, event.x, event.y);
+        return event;
+    }
+
+    std::vector<Tap> feed(const TouchTransform &transform, const std::vector<TouchEvent> &events) {
+        TouchTapDetector detector;
+        std::vector<Tap> taps;
+        for (const TouchEvent &event: events) {
+            int x, y, tapX, tapY;
+            transform.toLogical(event.x, event.y, x, y);
+            if (detector.feed(event.phase, x, y, tapX, tapY)) {
+                taps.push_back(Tap{tapX, tapY});
+            }
+        }
+        return taps;
+    }
+
+    void testTransform(const int rotation, const TouchTransform &transform, const FakeDisplay &display) {
+        check(transform.rotation == rotation, "forDisplay keeps the rotation", rotation);
+        check(transform.panelWidth == PANEL_WIDTH && transform.panelHeight == PANEL_HEIGHT,
+              "forDisplay reports the native panel size", rotation);
+
+        const int corners[][2] = {
+            {0, 0}, {display.width() - 1, 0}, {0, display.height() - 1}, {display.width() - 1, display.height() - 1},
+            {display.width() / 3, display.height() / 5}
+        };
+        for (const auto &corner: corners) {
+            int panelX, panelY, x, y;
+            toPanel(rotation, corner[0], corner[1], panelX, panelY);
+            check(panelX >= 0 && panelX < PANEL_WIDTH && panelY >= 0 && panelY < PANEL_HEIGHT,
+                  "logical point maps onto the panel", rotation);
+            transform.toLogical(panelX, panelY, x, y);
+            check(x == corner[0] && y == corner[1], "toLogical inverts the drawPixel mapping", rotation);
+        }
+    }
+
+    void testStreams(const int rotation, const TouchTransform &transform) {
+        constexpr int SLOP = TouchTapDetector::TAP_SLOP;
+        const int x = 120;
+        const int y = 200;
+        const auto at = [&](const TouchPhase phase, const int dx, const int dy) {
+            return touch(rotation, phase, x + dx, y + dy);
+        };
+
+        // Tap with jitter up to the slop, reported at the down position
+        std::vector<Tap> taps = feed(transform, {
+                                         at(TouchPhase::DOWN, 0, 0),
+                                         at(TouchPhase::MOVE, 3, -2),
+                                         at(TouchPhase::MOVE, SLOP, SLOP),
+                                         at(TouchPhase::UP, -SLOP, 4)
+                                     });
+        check(taps.size() == 1 && taps[0].x == x && taps[0].y == y, "tap within the slop", rotation);
+
+        // Release just past the slop without any move in between
+        taps = feed(transform, {at(TouchPhase::DOWN, 0, 0), at(TouchPhase::UP, 0, SLOP + 1)});
+        check(taps.empty(), "release past the slop is no tap", rotation);
+
+        // Drag along either logical axis
+        taps = feed(transform, {
+                        at(TouchPhase::DOWN, 0, 0),
+                        at(TouchPhase::MOVE, SLOP * 2, 0),
+                        at(TouchPhase::MOVE, SLOP * 4, 0),
+                        at(TouchPhase::UP, SLOP * 4, 0)
+                    });
+        check(taps.empty(), "horizontal drag is no tap", rotation);
+        taps = feed(transform, {at(TouchPhase::DOWN, 0, 0), at(TouchPhase::MOVE, 0, -SLOP - 1),
+                                at(TouchPhase::UP, 0, -SLOP - 1)});
+        check(taps.empty(), "vertical drag is no tap", rotation);
+
+        // Drag that comes back to where it started
+        taps = feed(transform, {
+                        at(TouchPhase::DOWN, 0, 0),
+                        at(TouchPhase::MOVE, SLOP + 8, SLOP + 8),
+                        at(TouchPhase::MOVE, 0, 0),
+                        at(TouchPhase::UP, 0, 0)
+                    });
+        check(taps.empty(), "drag back to the start is no tap", rotation);
+
+        // Contact bounce: a repeated down restarts the tap, a repeated or stray up is ignored
+        taps = feed(transform, {
+                        at(TouchPhase::UP, 0, 0),
+                        at(TouchPhase::DOWN, 0, 0),
+                        at(TouchPhase::DOWN, 2, 1),
+                        at(TouchPhase::UP, 2, 1),
+                        at(TouchPhase::UP, 2, 1)
+                    });
+        check(taps.size() == 1 && taps[0].x == x + 2 && taps[0].y == y + 1, "bounce gives one tap", rotation);
+
+        // Two taps in a row are two taps, a drag in between does not swallow the second
+        taps = feed(transform, {
+                        at(TouchPhase::DOWN, 0, 0), at(TouchPhase::UP, 0, 0),
+                        at(TouchPhase::DOWN, 0, 0), at(TouchPhase::MOVE, SLOP * 3, 0), at(TouchPhase::UP, SLOP * 3, 0),
+                        at(TouchPhase::DOWN, 40, 40), at(TouchPhase::UP, 40, 40)
+                    });
+        check(taps.size() == 2 && taps[1].x == x + 40 && taps[1].y == y + 40, "taps around a drag", rotation);
+    }
+}
+
+int main() {
+    for (int rotation = 0; rotation < 4; rotation++) {
+        FakeDisplay display{static_cast<uint8_t>(rotation)};
+        const TouchTransform transform = TouchTransform::forDisplay(display);
+        testTransform(rotation, transform, display);
+        testStreams(rotation, transform);
+    }
+
+    if (failures == 0) {
+        std::printf("touch: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
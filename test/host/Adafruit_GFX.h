@@ -0,0 +1,177 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+/**
+ * @file Adafruit_GFX.h
+ * Host model of Adafruit_GFX. Lines, rectangles and glyphs decay to
+ * writePixel -> drawPixel as upstream, so subclasses that override the fast
+ * paths see the same calls as on the device. Rounded shapes are drawn square.
+ */
+
+#include <Arduino.h>
+#include <utility>
+
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t *bitmap;
+    GFXglyph *glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(const int16_t w, const int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writePixel(const int16_t x, const int16_t y, const uint16_t color) { drawPixel(x, y, color); }
+
+    virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const uint16_t color) {
+        const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+        if (steep) {
+            std::swap(x0, y0);
+            std::swap(x1, y1);
+        }
+        if (x0 > x1) {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+        const int16_t dx = x1 - x0;
+        const int16_t dy = std::abs(y1 - y0);
+        const int16_t yStep = y0 < y1 ? 1 : -1;
+        int16_t err = dx / 2;
+        for (; x0 <= x1; x0++) {
+            steep ? writePixel(y0, x0, color) : writePixel(x0, y0, color);
+            err -= dy;
+            if (err < 0) {
+                y0 += yStep;
+                err += dx;
+            }
+        }
+    }
+
+    virtual void writeFastVLine(const int16_t x, const int16_t y, const int16_t h, const uint16_t c) { drawFastVLine(x, y, h, c); }
+    virtual void writeFastHLine(const int16_t x, const int16_t y, const int16_t w, const uint16_t c) { drawFastHLine(x, y, w, c); }
+    virtual void writeFillRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, const uint16_t c) { fillRect(x, y, w, h, c); }
+    virtual void fillScreen(const uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    virtual void drawLine(const int16_t x0, const int16_t y0, const int16_t x1, const int16_t y1, const uint16_t c) {
+        startWrite();
+        writeLine(x0, y0, x1, y1, c);
+        endWrite();
+    }
+
+    virtual void drawFastVLine(const int16_t x, const int16_t y, const int16_t h, const uint16_t c) {
+        startWrite();
+        writeLine(x, y, x, y + h - 1, c);
+        endWrite();
+    }
+
+    virtual void drawFastHLine(const int16_t x, const int16_t y, const int16_t w, const uint16_t c) {
+        startWrite();
+        writeLine(x, y, x + w - 1, y, c);
+        endWrite();
+    }
+
+    virtual void fillRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, const uint16_t c) {
+        startWrite();
+        for (int16_t i = x; i < x + w; i++) writeFastVLine(i, y, h, c);
+        endWrite();
+    }
+
+    virtual void drawRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, const uint16_t c) {
+        drawFastHLine(x, y, w, c);
+        drawFastHLine(x, y + h - 1, w, c);
+        drawFastVLine(x, y, h, c);
+        drawFastVLine(x + w - 1, y, h, c);
+    }
+
+    void drawRoundRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, int16_t, const uint16_t c) { drawRect(x, y, w, h, c); }
+    void fillRoundRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, int16_t, const uint16_t c) { fillRect(x, y, w, h, c); }
+    void drawCircle(int16_t, int16_t, int16_t, uint16_t) {}
+    void fillCircle(int16_t, int16_t, int16_t, uint16_t) {}
+    void drawTriangle(int16_t, int16_t, int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+    void fillTriangle(int16_t, int16_t, int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+    void drawBitmap(int16_t, int16_t, const uint8_t *, int16_t, int16_t, uint16_t) {}
+    void drawBitmap(int16_t, int16_t, const uint8_t *, int16_t, int16_t, uint16_t, uint16_t) {}
+
+    void drawChar(const int16_t x, const int16_t y, const unsigned char c, const uint16_t color, uint16_t, uint8_t) {
+        const GFXglyph *glyph = gfxFont->glyph + (c - gfxFont->first);
+        const uint8_t *bitmap = gfxFont->bitmap;
+        uint16_t offset = glyph->bitmapOffset;
+        uint8_t bits = 0;
+        uint8_t bit = 0;
+        startWrite();
+        for (uint8_t yy = 0; yy < glyph->height; yy++) {
+            for (uint8_t xx = 0; xx < glyph->width; xx++) {
+                if (!(bit++ & 7)) bits = bitmap[offset++];
+                if (bits & 0x80) writePixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, color);
+                bits <<= 1;
+            }
+        }
+        endWrite();
+    }
+
+    size_t write(const uint8_t c) override {
+        if (gfxFont == nullptr) return 1;
+        if (c == '\n') {
+            cursor_x = 0;
+            cursor_y += gfxFont->yAdvance;
+            return 1;
+        }
+        if (c < gfxFont->first || c > gfxFont->last) return 1;
+        const GFXglyph *glyph = gfxFont->glyph + (c - gfxFont->first);
+        if (glyph->width > 0 && glyph->height > 0) drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, 1);
+        cursor_x += glyph->xAdvance;
+        return 1;
+    }
+
+    void setCursor(const int16_t x, const int16_t y) { cursor_x = x; cursor_y = y; }
+    void setTextColor(const uint16_t c) { textcolor = c; }
+    void setTextColor(const uint16_t c, const uint16_t b) { textcolor = c; textbgcolor = b; }
+    void setTextSize(const uint8_t s) { textsize_x = textsize_y = s; }
+    void setTextWrap(const bool w) { wrap = w; }
+    void setFont(const GFXfont *f = nullptr) { gfxFont = const_cast<GFXfont *>(f); }
+
+    void setRotation(const uint8_t r) {
+        rotation = r & 3;
+        _width = rotation & 1 ? HEIGHT : WIDTH;
+        _height = rotation & 1 ? WIDTH : HEIGHT;
+    }
+
+    uint8_t getRotation() const { return rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    void getTextBounds(const char *, int16_t, int16_t, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+        *x1 = *y1 = 0;
+        *w = *h = 0;
+    }
+
+    void getTextBounds(const String &s, const int16_t x, const int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+        getTextBounds(s.c_str(), x, y, x1, y1, w, h);
+    }
+
+protected:
+    const int16_t WIDTH, HEIGHT;
+    int16_t _width, _height, cursor_x = 0, cursor_y = 0;
+    uint16_t textcolor = 0, textbgcolor = 0;
+    uint8_t textsize_x = 1, textsize_y = 1, rotation = 0;
+    bool wrap = true, _cp437 = false;
+    GFXfont *gfxFont = nullptr;
+};
+
+#endif //HOST_ADAFRUIT_GFX_H
@@ -0,0 +1,104 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * Host stand-in for the parts of the Arduino core the drawing headers use,
+ * so they compile for host tests. Nothing here talks to hardware.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+typedef uint8_t byte;
+
+class String {
+    std::string s;
+
+public:
+    String() = default;
+    String(const char *c) : s(c ? c : "") {}
+    explicit String(const int v) : s(std::to_string(v)) {}
+    explicit String(const unsigned int v) : s(std::to_string(v)) {}
+    explicit String(const long v) : s(std::to_string(v)) {}
+    explicit String(const unsigned long v) : s(std::to_string(v)) {}
+    explicit String(const float v, unsigned int = 2) : s(std::to_string(v)) {}
+    explicit String(const char c) : s(1, c) {}
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool concat(const char c) { s += c; return true; }
+    bool concat(const char *c) { s += c; return true; }
+    bool reserve(const unsigned int n) { s.reserve(n); return true; }
+    void remove(const unsigned int i, const unsigned int n = 1) { s.erase(i, n); }
+    char charAt(const unsigned int i) const { return s[i]; }
+    char operator[](const unsigned int i) const { return s[i]; }
+    char &operator[](const unsigned int i) { return s[i]; }
+    String substring(const unsigned int a, const unsigned int b) const { return String(s.substr(a, b - a).c_str()); }
+    String substring(const unsigned int a) const { return String(s.substr(a).c_str()); }
+    int indexOf(const char c) const { const auto p = s.find(c); return p == std::string::npos ? -1 : static_cast<int>(p); }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == o; }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator<(const String &o) const { return s < o.s; }
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o; return *this; }
+    String &operator+=(const char o) { s += o; return *this; }
+    friend String operator+(const String &a, const String &b) { String r = a; r += b; return r; }
+    friend String operator+(const String &a, const char *b) { String r = a; r += b; return r; }
+    friend String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+    friend String operator+(const String &a, const char b) { String r = a; r += b; return r; }
+};
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t) = 0;
+
+    size_t print(const char *s) { size_t n = 0; while (*s) n += write(*s++); return n; }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(const char c) { return write(c); }
+    size_t print(const int v) { return print(String(v)); }
+    size_t print(const unsigned int v) { return print(String(v)); }
+    size_t print(const long v) { return print(String(v)); }
+    size_t print(const unsigned long v) { return print(String(v)); }
+    size_t print(const double v, int = 2) { return print(String(static_cast<float>(v))); }
+    size_t println(const char *s = "") { return print(s); }
+    size_t println(const String &s) { return print(s); }
+    size_t println(const int v) { return print(v); }
+    size_t printf(const char *, ...) { return 0; }
+};
+
+/** Swallows all output so test logs only show the test's own lines. */
+class HardwareSerial : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    void begin(long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+inline HardwareSerial Serial;
+
+inline unsigned long millis() { return 0; }
+inline void delay(unsigned long) {}
+inline long random(const long max) { return max > 0 ? std::rand() % max : 0; }
+inline long random(const long min, const long max) { return max > min ? min + std::rand() % (max - min) : min; }
+
+#define MALLOC_CAP_SPIRAM 1
+#define MALLOC_CAP_8BIT 2
+inline void *heap_caps_malloc(const size_t size, uint32_t) { return std::malloc(size); }
+inline size_t heap_caps_get_free_size(uint32_t) { return 0; }
+
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_pointer(a) (*(void *const *)(a))
+
+#endif //HOST_ARDUINO_H
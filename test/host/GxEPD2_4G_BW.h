@@ -0,0 +1,114 @@
+#ifndef HOST_GXEPD2_4G_BW_H
+#define HOST_GXEPD2_4G_BW_H
+
+/**
+ * @file GxEPD2_4G_BW.h
+ * Host model of GxEPD2_4G_BW: a 1bpp page buffer for the current window,
+ * drawPixel and fillScreen as upstream, and drawPaged calling back once as
+ * a full-height page does. Nothing is sent to a panel.
+ */
+
+#include <Adafruit_GFX.h>
+#include <cstring>
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_DARKGREY 0x7BEF
+#define GxEPD_LIGHTGREY 0xC618
+
+template<typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_4G_BW : public Adafruit_GFX {
+public:
+    GxEPD2_Type epd2;
+
+    explicit GxEPD2_4G_BW(GxEPD2_Type driver)
+        : Adafruit_GFX(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(driver) {
+        setFullWindow();
+    }
+
+    void init(uint32_t, bool = false) {}
+
+    void drawPixel(int16_t x, int16_t y, const uint16_t color) override {
+        if (x < 0 || x >= width() || y < 0 || y >= height()) return;
+        switch (getRotation()) {
+            case 1:
+                std::swap(x, y);
+                x = WIDTH - x - 1;
+                break;
+            case 2:
+                x = WIDTH - x - 1;
+                y = HEIGHT - y - 1;
+                break;
+            case 3:
+                std::swap(x, y);
+                y = HEIGHT - y - 1;
+                break;
+            default:
+                break;
+        }
+        if (_using_partial_mode) {
+            if (x < _pw_x || x >= _pw_x + _pw_w || y < _pw_y || y >= _pw_y + _pw_h) return;
+            x -= _pw_x;
+            y -= _pw_y;
+        }
+        const uint32_t i = x / 8 + y * (_pw_w / 8);
+        if (color == GxEPD_WHITE) {
+            buffer[i] |= 1 << (7 - x % 8);
+        } else {
+            buffer[i] &= 0xFF ^ (1 << (7 - x % 8));
+        }
+    }
+
+    void fillScreen(const uint16_t color) override {
+        std::memset(buffer, color == GxEPD_WHITE ? 0xFF : 0x00, sizeof(buffer));
+    }
+
+    void setFullWindow() {
+        _using_partial_mode = false;
+        _pw_x = 0;
+        _pw_y = 0;
+        _pw_w = WIDTH;
+        _pw_h = HEIGHT;
+    }
+
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        // Logical to native as upstream, widened to whole bytes
+        switch (getRotation()) {
+            case 1:
+                std::swap(x, y);
+                std::swap(w, h);
+                x = WIDTH - x - w;
+                break;
+            case 2:
+                x = WIDTH - x - w;
+                y = HEIGHT - y - h;
+                break;
+            case 3:
+                std::swap(x, y);
+                std::swap(w, h);
+                y = HEIGHT - y - h;
+                break;
+            default:
+                break;
+        }
+        _pw_w = (x % 8 + w + 7) / 8 * 8;
+        _pw_x = x - x % 8;
+        _pw_y = y;
+        _pw_h = h;
+        _using_partial_mode = true;
+    }
+
+    void firstPage() {}
+    bool nextPage() { return false; }
+    void drawPaged(void (*callback)(const void *), const void *param) { callback(param); }
+    void display(bool = false) {}
+    void hibernate() {}
+    void powerOff() {}
+
+protected:
+    uint8_t buffer[GxEPD2_Type::WIDTH / 8 * page_height];
+    bool _using_partial_mode = false;
+    int16_t _pw_x = 0, _pw_y = 0, _pw_w = 0, _pw_h = 0;
+};
+
+#endif //HOST_GXEPD2_4G_BW_H
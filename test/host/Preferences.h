@@ -0,0 +1,15 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+/** @file Preferences.h Host stand-in for ESP32 Preferences; every key reads its default. */
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char *, bool) { return true; }
+    uint32_t getUInt(const char *, const uint32_t defaultValue = 0) { return defaultValue; }
+    size_t putUInt(const char *, uint32_t) { return sizeof(uint32_t); }
+};
+
+#endif //HOST_PREFERENCES_H
@@ -0,0 +1,14 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+/** @file SPI.h Host stand-in for the Arduino SPI bus. */
+
+class SPIClass {
+public:
+    void end() {}
+    void begin(int, int, int, int) {}
+};
+
+inline SPIClass SPI;
+
+#endif //HOST_SPI_H
@@ -0,0 +1,47 @@
+#ifndef HOST_FONTS_H
+#define HOST_FONTS_H
+
+/**
+ * @file fonts.h
+ * Host stand-in for the application's fonts header. Every face shares one
+ * synthetic monospace font whose glyphs differ per character, so text that
+ * lands in the wrong place changes the frame.
+ */
+
+#include <Adafruit_GFX.h>
+
+namespace HostFonts {
+    constexpr uint8_t FIRST = 0x20;
+    constexpr uint8_t LAST = 0x7E;
+    constexpr uint8_t GLYPH_WIDTH = 12;
+    constexpr uint8_t GLYPH_HEIGHT = 16;
+    constexpr uint16_t GLYPH_BYTES = GLYPH_WIDTH * GLYPH_HEIGHT / 8;
+
+    inline uint8_t bitmap[(LAST - FIRST + 1) * GLYPH_BYTES];
+    inline GFXglyph glyphs[LAST - FIRST + 1];
+
+    inline bool build() {
+        for (int c = FIRST; c <= LAST; c++) {
+            const int g = c - FIRST;
+            glyphs[g] = GFXglyph{static_cast<uint16_t>(g * GLYPH_BYTES), GLYPH_WIDTH, GLYPH_HEIGHT, 14, 1, -14};
+            for (int b = 0; b < GLYPH_BYTES; b++) {
+                bitmap[g * GLYPH_BYTES + b] = c == ' ' ? 0 : static_cast<uint8_t>(c * 37 + b * 101);
+            }
+        }
+        return true;
+    }
+
+    inline const bool built = build();
+    inline GFXfont font{bitmap, glyphs, FIRST, LAST, 24};
+}
+
+inline const GFXfont &FreeMono9pt7b = HostFonts::font;
+inline const GFXfont &FreeMono12pt7b = HostFonts::font;
+inline const GFXfont &FreeMono18pt7b = HostFonts::font;
+inline const GFXfont &FreeMono24pt7b = HostFonts::font;
+inline const GFXfont &FreeMonoBold9pt7b = HostFonts::font;
+inline const GFXfont &FreeMonoBold12pt7b = HostFonts::font;
+inline const GFXfont &FreeMonoBold18pt7b = HostFonts::font;
+inline const GFXfont &FreeMonoBold24pt7b = HostFonts::font;
+
+#endif //HOST_FONTS_H
@@ -0,0 +1,16 @@
+#ifndef HOST_GXEPD2_750_GDEY075T7_H
+#define HOST_GXEPD2_750_GDEY075T7_H
+
+/** @file GxEPD2_750_GDEY075T7.h Host stand-in for the 7.5" panel driver: only its size. */
+
+#include <cstdint>
+
+class GxEPD2_750_GDEY075T7 {
+public:
+    static const uint16_t WIDTH = 800;
+    static const uint16_t HEIGHT = 480;
+
+    GxEPD2_750_GDEY075T7(int16_t, int16_t, int16_t, int16_t) {}
+};
+
+#endif //HOST_GXEPD2_750_GDEY075T7_H